@@ -35,6 +35,26 @@ using namespace calf_plugins;
 #define sinc(x) (x == 0) ? 1 : sin(M_PI * x)/(M_PI * x);
 #define RGBAtoINT(r, g, b, a) ((uint32_t)(r * 255) << 24) + ((uint32_t)(g * 255) << 16) + ((uint32_t)(b * 255) << 8) + (uint32_t)(a * 255)
 
+analyzer::settings::settings()
+{
+    accuracy        = -1;
+    acc             = -1;
+    scale           = -1;
+    post            = -1;
+    hold            = -1;
+    smooth          = -1;
+    speed           = -1;
+    windowing       = -1;
+    view            = -1;
+    freeze          = -1;
+    mode            = -1;
+    resolution      = -1.f;
+    offset          = -1.f;
+    srate           = 0;
+    sanitize_serial = 0;
+    plan_serial     = 0;
+}
+
 analyzer::analyzer() {
     _accuracy       = -1;
     _acc            = -1;
@@ -51,8 +71,11 @@ analyzer::analyzer() {
     _speed          = -1;
     fpos            = 0;
     _draw_upper     = 0;
+    srate           = 0;
     sanitize        = true;
     recreate_plan   = true;
+    sanitize_seen   = 0;
+    plan_seen       = 0;
     
     spline_buffer = (int*) calloc(200, sizeof(int));
     
@@ -95,53 +118,73 @@ analyzer::~analyzer()
     free(spline_buffer);
 }
 void analyzer::set_sample_rate(uint32_t sr) {
-    srate = sr;
+    params.srate = sr;
+    publish_params();
 }
 
 void analyzer::set_params(float resolution, float offset, int accuracy, int hold, int smoothing, int mode, int scale, int post, int speed, int windowing, int view, int freeze)
 {
-    _speed     = speed;
-    _windowing = windowing;
-    _freeze    = freeze;
-    _view      = view;
+    params.speed     = speed;
+    params.windowing = windowing;
+    params.freeze    = freeze;
+    params.view      = view;
+    params.resolution = resolution;
+    params.offset    = offset;
     
-    if(accuracy != _acc) {
-        _accuracy = 1 << (7 + (int)accuracy);
-        _acc = accuracy;
-        recreate_plan = true;
-    }
-    if(hold != _hold) {
-        _hold = hold;
-        sanitize = true;
+    if(accuracy != params.acc) {
+        params.accuracy = 1 << (7 + (int)accuracy);
+        params.acc = accuracy;
+        params.plan_serial++;
     }
-    if(smoothing != _smooth) {
-        _smooth = smoothing;
-        sanitize = true;
+    if(hold != params.hold || smoothing != params.smooth || mode != params.mode
+        || scale != params.scale || post != params.post) {
+        params.hold   = hold;
+        params.smooth = smoothing;
+        params.mode   = mode;
+        params.scale  = scale;
+        params.post   = post;
+        params.sanitize_serial++;
     }
-    if (mode != _mode) {
-        _mode = mode;
-        sanitize = true;
+    publish_params();
+}
+void analyzer::publish_params()
+{
+    params_snapshot.get_write() = params;
+    params_snapshot.publish();
+}
+void analyzer::fetch_params() const
+{
+    const settings &s = params_snapshot.get_read();
+    if (s.mode != _mode || s.resolution != _resolution || s.offset != _offset)
         redraw_graph = true;
+    if (s.plan_serial != plan_seen) {
+        plan_seen = s.plan_serial;
+        recreate_plan = true;
     }
-    if(scale != _scale) {
-        _scale = scale;
-        sanitize = true;
-    }
-    if(post != _post) {
-        _post = post;
+    if (s.sanitize_serial != sanitize_seen) {
+        sanitize_seen = s.sanitize_serial;
         sanitize = true;
     }
-    if(resolution != _resolution || offset != _offset) {
-        _resolution = resolution;
-        _offset = offset;
-        redraw_graph = true;
-    }
+    _accuracy   = s.accuracy;
+    _acc        = s.acc;
+    _scale      = s.scale;
+    _post       = s.post;
+    _hold       = s.hold;
+    _smooth     = s.smooth;
+    _speed      = s.speed;
+    _windowing  = s.windowing;
+    _view       = s.view;
+    _freeze     = s.freeze;
+    _mode       = s.mode;
+    _resolution = s.resolution;
+    _offset     = s.offset;
+    srate       = s.srate;
 }
 void analyzer::process(float L, float R) {
-    fft_buffer[fpos] = L;
-    fft_buffer[fpos + 1] = R;
-    fpos += 2;
-    fpos %= (max_fft_buffer_size - 2);
+    int pos = fpos;
+    fft_buffer[pos] = L;
+    fft_buffer[pos + 1] = R;
+    fpos = (pos + 2) % (max_fft_buffer_size - 2);
 }
 
 bool analyzer::do_fft(int subindex, int points) const
@@ -190,10 +233,11 @@ bool analyzer::do_fft(int subindex, int points) const
             // buffer to send it to fft afterwards
             // we want to remember old fft_out values for smoothing as well
             // and we fill the hold buffer in this (extra) cycle
+            int wpos = fpos;
             for(int i = 0; i < _accuracy; i++) {
                 // go to the right position back in time according to accuracy
                 // settings and cycling in the main buffer
-                int _fpos = (fpos - _accuracy * 2 \
+                int _fpos = (wpos - _accuracy * 2 \
                     + (i * 2)) % max_fft_buffer_size;
                 if(_fpos < 0)
                     _fpos = max_fft_buffer_size + _fpos;
@@ -783,6 +827,8 @@ bool analyzer::get_graph(int subindex, int phase, float *data, int points, cairo
 {
     if (!phase)
         return false;
+    if (!subindex)
+        fetch_params();
     
     if ((subindex == 1 && !_hold && _mode < 3) \
      || (subindex > 1  && _mode < 3) \
@@ -886,6 +932,8 @@ bool analyzer::get_graph(int subindex, int phase, float *data, int points, cairo
 
 bool analyzer::get_moving(int subindex, int &direction, float *data, int x, int y, int &offset, uint32_t &color) const
 {
+    if (!subindex)
+        fetch_params();
     if ((subindex && _mode != 9) || subindex > 1)
         return false;
     bool fftdone = false;
@@ -1046,6 +1094,7 @@ bool analyzer::get_gridline(int subindex, int phase, float &pos, bool &vertical,
     
 bool analyzer::get_layers(int generation, unsigned int &layers) const
 {
+    fetch_params();
     if (_mode > 5 && _mode < 11)
         layers = LG_REALTIME_MOVING;
     else
@@ -21,59 +21,66 @@
 
 #include <calf/audio_fx.h>
 #include <calf/giface.h>
+#include <calf/utils.h>
 #include <limits.h>
 #include <stdlib.h>
 #include <time.h>
 #include <math.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <list>
 
 using namespace calf_plugins;
 using namespace dsp;
 
-simple_phaser::simple_phaser(int _max_stages, float *x1vals, float *y1vals)
+stereo_phaser::stereo_phaser()
 {
-    max_stages = _max_stages;
-    x1 = x1vals;
-    y1 = y1vals;
-
     set_base_frq(1000);
     set_mod_depth(1000);
     set_fb(0);
-    state = 0;
+    r_phase = 0;
+    stages = MaxStages;
     cnt = 0;
-    stages = 0;
-    set_stages(_max_stages);
+    for (int c = 0; c < 2; c++)
+        a0[c] = da0[c] = state[c] = 0;
+    for (int i = 0; i <= MaxStages; i++)
+        z[i][0] = z[i][1] = 0;
 }
 
-void simple_phaser::set_stages(int _stages)
+void stereo_phaser::set_stages(int _stages)
 {
-    if (_stages > stages)
+    assert(_stages >= 1 && _stages <= MaxStages);
+    _stages = std::max(1, std::min<int>(MaxStages, _stages));
+    // start the added stages from the output of the old last stage
+    for (int i = stages + 1; i <= _stages; i++)
     {
-        assert(_stages <= max_stages);
-        if (_stages > max_stages)
-            _stages = max_stages;
-        for (int i = stages; i < _stages; i++)
-        {
-            x1[i] = x1[stages-1];
-            y1[i] = y1[stages-1];
-        }
+        z[i][0] = z[stages][0];
+        z[i][1] = z[stages][1];
     }
     stages = _stages;
 }
 
-void simple_phaser::reset()
+void stereo_phaser::reset()
 {
-    cnt = 0;
-    state = 0;
+    state[0] = state[1] = 0;
     phase.set(0);
-    for (int i = 0; i < max_stages; i++)
-        x1[i] = y1[i] = 0;
+    for (int i = 0; i <= MaxStages; i++)
+        z[i][0] = z[i][1] = 0;
     control_step();
+    // no ramp from whatever the previous coefficient was
+    for (int c = 0; c < 2; c++)
+    {
+        a0[c] += da0[c] * SubBlock;
+        da0[c] = 0;
+    }
 }
 
-void simple_phaser::control_step()
+float stereo_phaser::coeff_at(fixed_point<unsigned int, 20> ph) const
 {
-    cnt = 0;
-    int v = phase.get() + 0x40000000;
+    int v = ph.get() + 0x40000000;
     int sign = v >> 31;
     v ^= sign;
     // triangle wave, range from 0 to INT_MAX
@@ -81,43 +88,93 @@ void simple_phaser::control_step()
 
     float freq = base_frq * pow(2.0, vf * mod_depth / 1200.0);
     freq = dsp::clip<float>(freq, 10.0, 0.49 * sample_rate);
-    stage1.set_ap_w(freq * (M_PI / 2.0) * odsr);
+    // first order allpass, see onepole::set_ap_w
+    float x = tan(freq * (M_PI / 2.0) * odsr);
+    return (x - 1) / (x + 1);
+}
+
+void stereo_phaser::control_step()
+{
+    cnt = SubBlock;
+    // ramp to the coefficients for the current LFO position over the next sub-block
+    float target[2] = { coeff_at(phase), coeff_at(phase + r_phase) };
+    for (int c = 0; c < 2; c++)
+        da0[c] = (target[c] - a0[c]) * (1.f / SubBlock);
     if (lfo_active)
-        phase += dphase * 32;
-    for (int i = 0; i < stages; i++)
+        phase += dphase * SubBlock;
+    for (int i = 0; i <= stages; i++)
     {
-        dsp::sanitize(x1[i]);
-        dsp::sanitize(y1[i]);
+        dsp::sanitize(z[i][0]);
+        dsp::sanitize(z[i][1]);
     }
-    dsp::sanitize(state);
+    dsp::sanitize(state[0]);
+    dsp::sanitize(state[1]);
 }
 
-void simple_phaser::process(float *buf_out, float *buf_in, int nsamples, bool active, float level_in, float level_out)
+void stereo_phaser::process(float *out_l, float *out_r, const float *in_l, const float *in_r, int nsamples, bool active, float level_in, float level_out)
 {
-    for (int i=0; i<nsamples; i++) {
-        cnt++;
-        if (cnt == 32)
+    // work on local copies, so that the compiler can keep both lanes in
+    // registers and vectorize the per-stage arithmetic
+    float a[2] = { a0[0], a0[1] }, da[2] = { da0[0], da0[1] };
+    float st[2] = { state[0], state[1] };
+    float fbk = fb;
+    int nstages = stages;
+    for (int i = 0; i < nsamples; )
+    {
+        if (!cnt)
+        {
+            a0[0] = a[0]; a0[1] = a[1];
+            state[0] = st[0]; state[1] = st[1];
             control_step();
-        float in = *buf_in++ * level_in;
-        float fd = in + state * fb;
-        for (int j = 0; j < stages; j++)
-            fd = stage1.process_ap(fd, x1[j], y1[j]);
-        state = fd;
-
-        float sdry = in * gs_dry.get();
-        float swet = fd * gs_wet.get();
-        *buf_out++ = (sdry + (active ? swet : 0)) * level_out;
+            da[0] = da0[0]; da[1] = da0[1];
+            st[0] = state[0]; st[1] = state[1];
+        }
+        int n = std::min(cnt, nsamples - i);
+        cnt -= n;
+        for (int end = i + n; i < end; i++)
+        {
+            float in[2] = { in_l[i] * level_in, in_r[i] * level_in };
+            float fd[2];
+            for (int c = 0; c < 2; c++)
+            {
+                a[c] += da[c];
+                fd[c] = in[c] + st[c] * fbk;
+            }
+            for (int j = 0; j < nstages; j++)
+            {
+                float *x = z[j], *y = z[j + 1];
+                for (int c = 0; c < 2; c++)
+                {
+                    float out = (fd[c] - y[c]) * a[c] + x[c];
+                    x[c] = fd[c];
+                    fd[c] = out;
+                }
+            }
+            float *y = z[nstages];
+            float dry = gs_dry.get(), wet = gs_wet.get();
+            if (!active)
+                wet = 0.f;
+            for (int c = 0; c < 2; c++)
+            {
+                y[c] = st[c] = fd[c];
+                fd[c] = (in[c] * dry + fd[c] * wet) * level_out;
+            }
+            out_l[i] = fd[0];
+            out_r[i] = fd[1];
+        }
     }
+    a0[0] = a[0]; a0[1] = a[1];
+    state[0] = st[0]; state[1] = st[1];
 }
 
-float simple_phaser::freq_gain(float freq, float sr) const
+float stereo_phaser::freq_gain(int lane, float freq, float sr) const
 {
     typedef std::complex<double> cfloat;
     freq *= 2.0 * M_PI / sr;
     cfloat z = 1.0 / exp(cfloat(0.0, freq)); // z^-1
 
     cfloat p = cfloat(1.0);
-    cfloat stg = stage1.h_z(z);
+    cfloat stg = (cfloat(a0[lane]) + z) / (cfloat(1.0) + cfloat(a0[lane]) * z);
 
     for (int i = 0; i < stages; i++)
         p = p * stg;
@@ -376,8 +433,11 @@ tap_distortion::tap_distortion()
     srate = 0;
     meter = 0.f;
     rdrive = rbdr = kpa = kpb = kna = knb = ap = an = imr = kc = srct = sq = pwrq = prev_med = prev_out = 0.f;
+    prev_x = prev_F = 0.0;
+    hp = rp = hn = rn = p0p = p0n = 0.0;
     drive_old = blend_old = -1.f;
     over = 1;
+    quality = quality_oversampled;
 }
 
 void tap_distortion::activate()
@@ -409,6 +469,15 @@ void tap_distortion::set_params(float blend, float drive)
         imr = 2.0f * knb + D(2.0f * kna + 4.0f * an - 1.0f);
         pwrq = 2.0f / (imr + 1.0f);
 
+        // ap + x * (kpa - x) = rp^2 - (x - hp)^2, an - x * (kna + x) = rn^2 - (x - hn)^2
+        hp = kpa * 0.5;
+        rp = sqrt(std::max(0.0, ap + hp * hp));
+        hn = -kna * 0.5;
+        rn = sqrt(std::max(0.0, an + hn * hn));
+        p0p = sqrt_abs_integral(-hp, rp);
+        p0n = sqrt_abs_integral(-hn, rn);
+        prev_F = antiderivative(prev_x);
+
         drive_old = drive;
         blend_old = blend;
     }
@@ -417,22 +486,78 @@ void tap_distortion::set_params(float blend, float drive)
 void tap_distortion::set_sample_rate(uint32_t sr)
 {
     srate = sr;
-    over = srate * 2 > 96000 ? 1 : 2;
+    if (quality == quality_adaa)
+        over = 1;
+    else
+        over = srate * 2 > 96000 ? 1 : 2;
     resampler.set_params(srate, over, 2);
 }
 
+void tap_distortion::set_quality(int q)
+{
+    q = std::min(std::max(q, 0), (int)quality_count - 1);
+    if (q == quality)
+        return;
+    quality = q;
+    set_sample_rate(srate);
+}
+
+inline float tap_distortion::shape(float proc) const
+{
+    if (proc >= 0.0f)
+        return (D(ap + proc * (kpa - proc)) + kpb) * pwrq;
+    else
+        return (D(an - proc * (kna + proc)) + knb) * pwrq * -1.0f;
+}
+
+/// Integral of sqrt(|r^2 - t^2|) dt from 0 to u
+double tap_distortion::sqrt_abs_integral(double u, double r)
+{
+    double au = fabs(u), r2 = r * r, v;
+    if (r < 1e-9)
+        v = au * au * 0.5;
+    else if (au <= r)
+        v = 0.5 * (au * sqrt(r2 - au * au) + r2 * asin(au / r));
+    else {
+        double s = sqrt(au * au - r2);
+        v = r2 * (M_PI / 4) + 0.5 * (au * s - r2 * log((au + s) / r));
+    }
+    return u < 0 ? -v : v;
+}
+
+/// Antiderivative of shape(), zero at x = 0
+inline double tap_distortion::antiderivative(double x) const
+{
+    if (x >= 0.0)
+        return pwrq * (sqrt_abs_integral(x - hp, rp) - p0p + kpb * x);
+    else
+        return -pwrq * (sqrt_abs_integral(x - hn, rn) - p0n + knb * x);
+}
+
+/// First order antiderivative antialiasing: the average of the curve between
+/// the previous and the current input, instead of the curve at the current input
+inline float tap_distortion::shape_adaa(float proc)
+{
+    double F = antiderivative(proc);
+    double dx = proc - prev_x;
+    float med;
+    if (fabs(dx) > 1e-5)
+        med = (F - prev_F) / dx;
+    else
+        med = shape(0.5 * (proc + prev_x));
+    prev_x = proc;
+    prev_F = F;
+    return med;
+}
+
 float tap_distortion::process(float in)
 {
     double *samples = resampler.upsample((double)in);
     meter = 0.f;
+    bool adaa = quality != quality_oversampled;
     for (int o = 0; o < over; o++) {
         float proc = samples[o];
-        float med;
-        if (proc >= 0.0f) {
-            med = (D(ap + proc * (kpa - proc)) + kpb) * pwrq;
-        } else {
-            med = (D(an - proc * (kna + proc)) + knb) * pwrq * -1.0f;
-        }
+        float med = adaa ? shape_adaa(proc) : shape(proc);
         proc = srct * (med - prev_med + prev_out);
         prev_med = M(med);
         prev_out = M(proc);
@@ -1060,6 +1185,7 @@ crossover::crossover() {
 }
 void crossover::set_sample_rate(uint32_t sr) {
     srate = sr;
+    publish_graph();
 }
 void crossover::init(int c, int b, uint32_t sr) {
     channels = std::min(8, c);
@@ -1075,8 +1201,16 @@ void crossover::init(int c, int b, uint32_t sr) {
             out[c][b] = 0.f;
         }
     }
+    publish_graph();
 }
 float crossover::set_filter(int b, float f, bool force) {
+    if (update_filter(b, f, force)) {
+        publish_graph();
+        redraw_graph = std::min(2, redraw_graph + 1);
+    }
+    return freq[b];
+}
+bool crossover::update_filter(int b, float f, bool force) {
     // keep between neighbour bands
     if (b)
         f = std::max((float)freq[b-1] * 1.1f, f);
@@ -1086,7 +1220,7 @@ float crossover::set_filter(int b, float f, bool force) {
     f = std::max(10.f, std::min(20000.f, f));
     // nothing changed? return
     if (freq[b] == f && !force)
-        return freq[b];
+        return false;
     freq[b] = f;
     float q;
     switch (mode) {
@@ -1126,28 +1260,45 @@ float crossover::set_filter(int b, float f, bool force) {
             hp[c][b][1].copy_coeffs(hp[c][b][0]);
         }
     }
-    redraw_graph = std::min(2, redraw_graph + 1);
-    return freq[b];
+    return true;
 }
 void crossover::set_mode(int m) {
     if(mode == m)
         return;
     mode = m;
     for(int i = 0; i < bands - 1; i ++) {
-        set_filter(i, freq[i], true);
+        update_filter(i, freq[i], true);
     }
+    publish_graph();
     redraw_graph = std::min(2, redraw_graph + 1);
 }
+void crossover::publish_graph() {
+    graph_state &gs = graph.get_write();
+    gs.bands   = std::max(0, bands);
+    gs.filters = get_filter_count();
+    gs.srate   = srate;
+    for (int b = 0; b < gs.bands; b++) {
+        gs.level[b]  = level[b];
+        gs.active[b] = active[b];
+        for (int f = 0; f < gs.filters; f++) {
+            gs.lp[b][f] = lp[0][b][f];
+            gs.hp[b][f] = hp[0][b][f];
+        }
+    }
+    graph.publish();
+}
 void crossover::set_active(int b, bool a) {
     if (active[b] == a)
         return;
     active[b] = a;
+    publish_graph();
     redraw_graph = std::min(2, redraw_graph + 1);
 }
 void crossover::set_level(int b, float l) {
     if (level[b] == l)
         return;
     level[b] = l;
+    publish_graph();
     redraw_graph = std::min(2, redraw_graph + 1);
 }
 void crossover::process(float *data) {
@@ -1173,7 +1324,8 @@ float crossover::get_value(int c, int b) {
 }
 bool crossover::get_graph(int subindex, int phase, float *data, int points, cairo_iface *context, int *mode) const
 {
-    if (subindex >= bands) {
+    const graph_state &gs = graph.get_read();
+    if (subindex >= gs.bands) {
         redraw_graph = std::max(0, redraw_graph - 1);
         return false;
     }
@@ -1182,14 +1334,14 @@ bool crossover::get_graph(int subindex, int phase, float *data, int points, cair
     for (int i = 0; i < points; i++) {
         ret = 1.f;
         freq = 20.0 * pow (20000.0 / 20.0, i * 1.0 / points);
-        for(int f = 0; f < get_filter_count(); f ++) {
-            if(subindex < bands -1)
-                ret *= lp[0][subindex][f].freq_gain(freq, (float)srate);
+        for(int f = 0; f < gs.filters; f ++) {
+            if(subindex < gs.bands -1)
+                ret *= gs.lp[subindex][f].freq_gain(freq, (float)gs.srate);
             if(subindex > 0)
-                ret *= hp[0][subindex - 1][f].freq_gain(freq, (float)srate);
+                ret *= gs.hp[subindex - 1][f].freq_gain(freq, (float)gs.srate);
         }
-        ret *= level[subindex];
-        context->set_source_rgba(0.15, 0.2, 0.0, !active[subindex] ? 0.3 : 0.8);
+        ret *= gs.level[subindex];
+        context->set_source_rgba(0.15, 0.2, 0.0, !gs.active[subindex] ? 0.3 : 0.8);
         data[i] = dB_grid(ret);
     }
     return true;
@@ -1430,3 +1582,244 @@ double samplereduction::process(double in)
     }
     return last;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+
+sf2_stereo_sample::sf2_stereo_sample()
+{
+    frames = NULL;
+    data[0] = data[1] = NULL;
+    length = loop_start = loop_end = 0;
+    sample_rate = 44100;
+}
+
+sf2_stereo_sample::~sf2_stereo_sample()
+{
+    close();
+}
+
+static inline uint32_t read_le32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+bool sf2_stereo_sample::open(const char *path)
+{
+    close();
+    int fd = ::open(path, O_RDONLY);
+    if (fd == -1)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) == -1 || st.st_size < 12) {
+        ::close(fd);
+        return false;
+    }
+    // the file is only mapped while looking for the samples, which are then
+    // copied, so that no page faults (and disk reads) happen during playback
+    size_t map_size = st.st_size;
+    void *base = mmap(NULL, map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED)
+        return false;
+    bool ok = parse((const uint8_t *)base, map_size);
+    munmap(base, map_size);
+    if (!ok)
+        close();
+    return ok;
+}
+
+bool sf2_stereo_sample::parse(const uint8_t *file, size_t file_size)
+{
+    if (memcmp(file, "RIFF", 4) || memcmp(file + 8, "sfbk", 4))
+        return false;
+    // look for sdta/smpl (sample data) and pdta/shdr (sample headers) chunks
+    const uint8_t *smpl = NULL, *shdr = NULL;
+    uint32_t smpl_size = 0, shdr_size = 0;
+    size_t end = std::min<size_t>(file_size, 8 + read_le32(file + 4));
+    for (size_t pos = 12; pos + 12 <= end; ) {
+        uint32_t size = read_le32(file + pos + 4);
+        if (!memcmp(file + pos, "LIST", 4)) {
+            size_t list_end = std::min<size_t>(end, pos + 8 + size);
+            for (size_t sub = pos + 12; sub + 8 <= list_end; ) {
+                uint32_t sub_size = read_le32(file + sub + 4);
+                if (sub + 8 + sub_size > list_end)
+                    break;
+                if (!memcmp(file + sub, "smpl", 4))
+                    smpl = file + sub + 8, smpl_size = sub_size;
+                else if (!memcmp(file + sub, "shdr", 4))
+                    shdr = file + sub + 8, shdr_size = sub_size;
+                sub += 8 + sub_size + (sub_size & 1);
+            }
+        }
+        pos += 8 + size + (size & 1);
+    }
+    if (!smpl || !shdr)
+        return false;
+    // sample header: name[20], start, end, loop start, loop end, sample rate, 
+    // original pitch, pitch correction, sample link, sample type (46 bytes total)
+    int found = 0;
+    uint32_t smpl_frames = smpl_size / 2;
+    const uint8_t *sdata[2] = { NULL, NULL };
+    for (uint32_t h = 0; h + 46 <= shdr_size; h += 46) {
+        const uint8_t *hdr = shdr + h;
+        int type = hdr[44] | (hdr[45] << 8);
+        int channel = type == 4 ? 0 : (type == 2 ? 1 : (type == 1 ? -1 : -2));
+        if (channel == -2)
+            continue;
+        uint32_t start = read_le32(hdr + 20), send = read_le32(hdr + 24);
+        if (start >= send || send > smpl_frames)
+            continue;
+        if (!found) {
+            length = send - start;
+            // loop points are absolute, only use them if they lie within the sample
+            uint32_t lstart = read_le32(hdr + 28), lend = read_le32(hdr + 32);
+            if (start <= lstart && lstart < lend && lend <= send) {
+                loop_start = lstart - start;
+                loop_end = lend - start;
+            }
+            else {
+                loop_start = 0;
+                loop_end = length;
+            }
+            sample_rate = read_le32(hdr + 36);
+        }
+        else
+            length = std::min(length, send - start);
+        if (channel == -1)
+            sdata[0] = sdata[1] = smpl + 2 * start;
+        else
+            sdata[channel] = smpl + 2 * start;
+        found++;
+        if (sdata[0] && sdata[1])
+            break;
+    }
+    if (!sdata[0] || !sdata[1] || !length)
+        return false;
+    frames = new int16_t[2 * length];
+    for (int c = 0; c < 2; c++) {
+        // SF2 sample data is always little endian
+        const uint8_t *src = sdata[c];
+        int16_t *dest = frames + c * length;
+        for (uint32_t i = 0; i < length; i++)
+            dest[i] = (int16_t)(src[2 * i] | (src[2 * i + 1] << 8));
+        data[c] = dest;
+    }
+    // use the whole sample if the loop points are missing or nonsensical
+    if (loop_end > length || loop_start + 32 > loop_end) {
+        loop_start = 0;
+        loop_end = length;
+    }
+    if (!sample_rate)
+        sample_rate = 44100;
+    return true;
+}
+
+void sf2_stereo_sample::close()
+{
+    delete []frames;
+    frames = NULL;
+    data[0] = data[1] = NULL;
+    length = loop_start = loop_end = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct sf2_sample_cache_entry
+{
+    std::string path;
+    /// Number of references handed out by acquire
+    int refcount;
+    sf2_stereo_sample *sample;
+};
+
+static calf_utils::ptmutex sf2_sample_cache_mutex;
+static std::list<sf2_sample_cache_entry> sf2_sample_cache_entries;
+
+const sf2_stereo_sample *sf2_sample_cache::acquire(const char *path)
+{
+    calf_utils::ptlock lock(sf2_sample_cache_mutex);
+    for (std::list<sf2_sample_cache_entry>::iterator i = sf2_sample_cache_entries.begin(); i != sf2_sample_cache_entries.end(); ++i)
+    {
+        if (i->path == path)
+        {
+            i->refcount++;
+            return i->sample;
+        }
+    }
+    sf2_stereo_sample *sample = new sf2_stereo_sample;
+    if (!sample->open(path))
+    {
+        delete sample;
+        return NULL;
+    }
+    sf2_sample_cache_entry entry;
+    entry.path = path;
+    entry.refcount = 1;
+    entry.sample = sample;
+    sf2_sample_cache_entries.push_back(entry);
+    return sample;
+}
+
+void sf2_sample_cache::release(const sf2_stereo_sample *sample)
+{
+    if (!sample)
+        return;
+    calf_utils::ptlock lock(sf2_sample_cache_mutex);
+    for (std::list<sf2_sample_cache_entry>::iterator i = sf2_sample_cache_entries.begin(); i != sf2_sample_cache_entries.end(); ++i)
+    {
+        if (i->sample == sample)
+        {
+            if (!--i->refcount)
+            {
+                delete i->sample;
+                sf2_sample_cache_entries.erase(i);
+            }
+            return;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+sample_layer::sample_layer()
+{
+    sample = NULL;
+    pos = 0;
+    step = 1;
+    gain = target_gain = 0.f;
+}
+
+void sample_layer::set_sample(const sf2_stereo_sample *s)
+{
+    sample = (s && s->is_open()) ? s : NULL;
+    pos = 0;
+}
+
+void sample_layer::set_speed(double ratio, uint32_t sr)
+{
+    if (sample)
+        step = ratio * sample->sample_rate / sr;
+}
+
+void sample_layer::render_to(float *left, float *right, uint32_t nsamples)
+{
+    if (!is_audible() || !nsamples)
+        return;
+    float g = gain, dg = (target_gain - gain) / nsamples;
+    double loop_start = sample->loop_start, loop_end = sample->loop_end;
+    double loop_len = loop_end - loop_start;
+    uint32_t last = sample->loop_end - 1;
+    for (uint32_t i = 0; i < nsamples; i++) {
+        uint32_t ipos = (uint32_t)pos;
+        float frac = pos - ipos;
+        // interpolate across the loop point
+        uint32_t ipos2 = ipos < last ? ipos + 1 : sample->loop_start;
+        left[i] += g * (sample->get(0, ipos) + (sample->get(0, ipos2) - sample->get(0, ipos)) * frac);
+        right[i] += g * (sample->get(1, ipos) + (sample->get(1, ipos2) - sample->get(1, ipos)) * frac);
+        g += dg;
+        pos += step;
+        if (pos >= loop_end)
+            pos -= loop_len;
+    }
+    gain = target_gain;
+}
@@ -25,9 +25,15 @@
 #include <calf/modules_tools.h>
 #include <calf/modules_delay.h>
 #include <calf/modules_comp.h>
+#include <calf/modules_limit.h>
 #include <calf/modules_dev.h>
+#include <calf/modules_dist.h>
 #include <calf/modules_filter.h>
 #include <calf/modules_mod.h>
+#include <calf/modules_pitch.h>
+#include <calf/modules_synths.h>
+#include <calf/organ.h>
+#include <calf/preset.h>
 #else
 #include <config.h>
 #endif
@@ -37,6 +43,7 @@
 #include <calf/loudness.h>
 #include <calf/benchmark.h>
 #include <getopt.h>
+#include <sys/wait.h>
 
 // #define TEST_OSC
 
@@ -229,11 +236,23 @@ struct __attribute__((aligned(8))) misaligned_double: public alignment_test
 };
 
 const char *unit = NULL;
+/// settings of the plugins and footprint units
+const char *plugin_filter = NULL, *json_name = NULL, *presets_name = NULL;
+std::vector<uint32_t> sample_rates, block_sizes;
+double run_seconds = 0.5;
+int run_count = 5;
 
 static struct option long_options[] = {
     {"help", 0, 0, 'h'},
     {"version", 0, 0, 'v'},
     {"unit", 1, 0, 'u'},
+    {"plugin", 1, 0, 'p'},
+    {"json", 1, 0, 'j'},
+    {"presets", 1, 0, 'P'},
+    {"sample-rates", 1, 0, 'r'},
+    {"block-sizes", 1, 0, 'b'},
+    {"seconds", 1, 0, 's'},
+    {"runs", 1, 0, 'n'},
     {0,0,0,0},
 };
 
@@ -379,11 +398,381 @@ void effect_test()
     dsp::do_simple_benchmark<effect_benchmark<calf_plugins::multichorus_audio_module> >(5, 10000);
 }
 
+/// Noise and a few sines at around -12 dBFS
+static void fill_test_signal(std::vector<float> &data)
+{
+    uint32_t seed = 1;
+    for (uint32_t i = 0; i < data.size(); i++) {
+        seed = seed * 1103515245 + 12345;
+        float noise = (int32_t)seed * (1.0f / 2147483648.0f);
+        data[i] = 0.1f * noise + 0.05f * (sin(i * 0.013) + sin(i * 0.11) + sin(i * 0.37));
+    }
+}
+
+template<class Benchmark>
+static void write_json_file(Benchmark &bench)
+{
+    if (!json_name)
+        return;
+    FILE *f = strcmp(json_name, "-") ? fopen(json_name, "w") : stdout;
+    if (!f) {
+        perror(json_name);
+        return;
+    }
+    bench.write_json(f);
+    if (f != stdout)
+        fclose(f);
+}
+
+static std::string json_string(const std::string &s)
+{
+    std::string r = "\"";
+    for (unsigned int i = 0; i < s.length(); i++) {
+        if (s[i] == '"' || s[i] == '\\')
+            r += '\\';
+        if ((unsigned char)s[i] >= 32)
+            r += s[i];
+    }
+    return r + "\"";
+}
+
+/// Benchmark of a complete plugin, for every module in modulelist.h
+struct plugin_benchmark
+{
+    struct module_info
+    {
+        const char *name;
+        bool is_synth;
+        calf_plugins::audio_module_iface *(*create)();
+        const calf_plugins::plugin_metadata_iface *(*metadata)();
+    };
+    struct result
+    {
+        std::string plugin, preset;
+        uint32_t sample_rate, block_size;
+        /// median processing time per sample in seconds, and the fastest run
+        double median, best;
+    };
+    template<class Module>
+    static calf_plugins::audio_module_iface *create_module() { return new Module; }
+    template<class Module>
+    static const calf_plugins::plugin_metadata_iface *module_metadata() { static typename Module::metadata_type md; return &md; }
+    static const module_info modules[];
+    /// Is the module selected with --plugin (case insensitive)?
+    static bool selected(const module_info &mi) { return !plugin_filter || !strcasecmp(plugin_filter, mi.name); }
+
+    calf_plugins::preset_list presets;
+    std::vector<result> results;
+
+    /// Measure one plugin with one preset (NULL for default values)
+    void measure(const module_info &mi, const calf_plugins::plugin_preset *preset, uint32_t srate, uint32_t block_size);
+    void run();
+    void write_json(FILE *f);
+};
+
+const plugin_benchmark::module_info plugin_benchmark::modules[] = {
+#define PER_MODULE_ITEM(name, isSynth, jackname) { jackname, isSynth, create_module<calf_plugins::name##_audio_module>, module_metadata<calf_plugins::name##_audio_module> },
+#include <calf/modulelist.h>
+};
+
+void plugin_benchmark::measure(const module_info &mi, const calf_plugins::plugin_preset *preset, uint32_t srate, uint32_t block_size)
+{
+    calf_plugins::audio_module_iface *module = mi.create();
+    const calf_plugins::plugin_metadata_iface *md = module->get_metadata_iface();
+    float **ins, **outs, **params;
+    module->get_port_arrays(ins, outs, params);
+
+    // one second of noise and a few sines at around -12 dBFS, looped
+    uint32_t in_len = srate;
+    int in_count = md->get_input_count(), out_count = md->get_output_count(), param_count = md->get_param_count();
+    std::vector<float> input(in_len * std::max(in_count, 1) + block_size);
+    fill_test_signal(input);
+    std::vector<float> output(out_count * block_size);
+    std::vector<float> values(param_count);
+    for (int i = 0; i < param_count; i++) {
+        values[i] = md->get_param_props(i)->def_value;
+        params[i] = &values[i];
+    }
+    if (preset) {
+        for (unsigned int i = 0; i < preset->param_names.size(); i++)
+            for (int j = 0; j < param_count; j++)
+                if (preset->param_names[i] == md->get_param_props(j)->short_name)
+                    values[j] = preset->values[i];
+    }
+    for (int i = 0; i < out_count; i++)
+        outs[i] = &output[i * block_size];
+
+    module->post_instantiate(srate);
+    module->set_sample_rate(srate);
+    if (preset) {
+        for (std::map<std::string, std::string>::const_iterator i = preset->variables.begin(); i != preset->variables.end(); ++i) {
+            char *error = module->configure(i->first.c_str(), i->second.c_str());
+            if (error)
+                free(error);
+        }
+    }
+    module->activate();
+    module->params_changed();
+
+    uint32_t pos = 0;
+    uint32_t blocks_per_run = std::max<uint32_t>(1, run_seconds * srate / block_size);
+    dsp::median_stat stat;
+    stat.start(run_count);
+    // the first run is a warm-up, for the caches, delay lines and envelopes to settle down
+    for (int run = -1; run < run_count; run++) {
+        if (mi.is_synth) {
+            // a chord for every run, so that the envelopes don't die out
+            static const int chord[] = { 60, 64, 67 };
+            for (int i = 0; i < 3; i++)
+            {
+                module->note_off(0, chord[i], 0);
+                module->note_on(0, chord[i], 100);
+            }
+        }
+        double start = dsp::benchmark_clock();
+        for (uint32_t b = 0; b < blocks_per_run; b++) {
+            for (int i = 0; i < in_count; i++)
+                ins[i] = &input[i * in_len + pos];
+            module->process_slice(0, block_size);
+            module->params_reset();
+            pos += block_size;
+            if (pos >= in_len)
+                pos -= in_len;
+        }
+        double elapsed = (dsp::benchmark_clock() - start) / (blocks_per_run * block_size);
+        if (run >= 0)
+            stat.add(elapsed);
+    }
+    stat.end();
+    module->deactivate();
+    delete module;
+
+    result r;
+    r.plugin = mi.name;
+    r.preset = preset ? preset->name : "default";
+    r.sample_rate = srate;
+    r.block_size = block_size;
+    r.median = stat.get();
+    r.best = stat.data[0];
+    results.push_back(r);
+    printf("%-20s %-24s %6u %5u: %8.1f ns/sample, %6.2f%% CPU\n", r.plugin.c_str(), r.preset.c_str(), srate, block_size, r.median * 1e9, r.median * srate * 100);
+    fflush(stdout);
+}
+
+void plugin_benchmark::run()
+{
+    if (presets_name) {
+        try {
+            presets.load(presets_name, false);
+        }
+        catch(calf_plugins::preset_exception &e) {
+            fprintf(stderr, "Cannot load presets: %s\n", e.what());
+        }
+    }
+    else
+        presets.load_defaults(true);
+    for (unsigned int m = 0; m < sizeof(modules) / sizeof(modules[0]); m++) {
+        const module_info &mi = modules[m];
+        if (!selected(mi))
+            continue;
+        calf_plugins::preset_vector plugin_presets;
+        calf_plugins::audio_module_iface *module = mi.create();
+        presets.get_for_plugin(plugin_presets, module->get_metadata_iface()->get_id());
+        delete module;
+        for (unsigned int r = 0; r < sample_rates.size(); r++)
+            for (unsigned int b = 0; b < block_sizes.size(); b++) {
+                measure(mi, NULL, sample_rates[r], block_sizes[b]);
+                for (unsigned int p = 0; p < plugin_presets.size(); p++)
+                    measure(mi, &plugin_presets[p], sample_rates[r], block_sizes[b]);
+            }
+    }
+}
+
+void plugin_benchmark::write_json(FILE *f)
+{
+    fprintf(f, "{\n  \"version\": %s,\n  \"runs\": %d,\n  \"seconds_per_run\": %g,\n  \"results\": [\n", json_string(PACKAGE_STRING).c_str(), run_count, run_seconds);
+    for (unsigned int i = 0; i < results.size(); i++) {
+        const result &r = results[i];
+        fprintf(f, "    {\"plugin\": %s, \"preset\": %s, \"sample_rate\": %u, \"block_size\": %u, \"ns_per_sample\": %.3f, \"best_ns_per_sample\": %.3f, \"cpu_percent\": %.4f}%s\n",
+            json_string(r.plugin).c_str(), json_string(r.preset).c_str(), r.sample_rate, r.block_size,
+            r.median * 1e9, r.best * 1e9, r.median * r.sample_rate * 100, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+}
+
+void plugin_test()
+{
+    plugin_benchmark bench;
+    bench.run();
+    write_json_file(bench);
+}
+
+/// Instantiation cost of every module in modulelist.h: time taken by each
+/// step of the setup and teardown, and growth of the resident set. Every
+/// plugin is measured in a child process of its own, so that static tables
+/// and memory recycled by the allocator are attributed to the right module.
+struct footprint_benchmark
+{
+    struct sample
+    {
+        /// seconds spent in construction (with post_instantiate), set_sample_rate,
+        /// activate (with params_changed), the first block and deactivate + delete
+        double create, set_sample_rate, activate, first_process, teardown;
+        /// resident set growth in bytes after each of the steps above (including
+        /// the code pages touched for the first time)
+        long rss_create, rss_set_sample_rate, rss_activate, rss_first_process, rss_teardown;
+    };
+    struct result: public sample
+    {
+        std::string plugin;
+        uint32_t sample_rate;
+    };
+    std::vector<result> results;
+
+    static void measure(const plugin_benchmark::module_info &mi, uint32_t srate, uint32_t block_size, sample &s);
+    static bool measure_in_child(const plugin_benchmark::module_info &mi, uint32_t srate, uint32_t block_size, sample &s);
+    void run();
+    void write_json(FILE *f);
+};
+
+void footprint_benchmark::measure(const plugin_benchmark::module_info &mi, uint32_t srate, uint32_t block_size, sample &s)
+{
+    const calf_plugins::plugin_metadata_iface *md = mi.metadata();
+    int in_count = md->get_input_count(), out_count = md->get_output_count(), param_count = md->get_param_count();
+    std::vector<float> input(std::max(in_count, 1) * block_size), output(std::max(out_count, 1) * block_size), values(param_count);
+    fill_test_signal(input);
+    for (int i = 0; i < param_count; i++)
+        values[i] = md->get_param_props(i)->def_value;
+    long rss = dsp::resident_memory();
+
+    double start = dsp::benchmark_clock();
+    calf_plugins::audio_module_iface *module = mi.create();
+    float **ins, **outs, **params;
+    module->get_port_arrays(ins, outs, params);
+    for (int i = 0; i < param_count; i++)
+        params[i] = &values[i];
+    for (int i = 0; i < in_count; i++)
+        ins[i] = &input[i * block_size];
+    for (int i = 0; i < out_count; i++)
+        outs[i] = &output[i * block_size];
+    module->post_instantiate(srate);
+    s.create = dsp::benchmark_clock() - start;
+    s.rss_create = dsp::resident_memory() - rss;
+
+    start = dsp::benchmark_clock();
+    module->set_sample_rate(srate);
+    s.set_sample_rate = dsp::benchmark_clock() - start;
+    s.rss_set_sample_rate = dsp::resident_memory() - rss;
+
+    start = dsp::benchmark_clock();
+    module->activate();
+    module->params_changed();
+    s.activate = dsp::benchmark_clock() - start;
+    s.rss_activate = dsp::resident_memory() - rss;
+
+    start = dsp::benchmark_clock();
+    module->process_slice(0, block_size);
+    module->params_reset();
+    s.first_process = dsp::benchmark_clock() - start;
+    s.rss_first_process = dsp::resident_memory() - rss;
+
+    start = dsp::benchmark_clock();
+    module->deactivate();
+    delete module;
+    s.teardown = dsp::benchmark_clock() - start;
+    s.rss_teardown = dsp::resident_memory() - rss;
+}
+
+bool footprint_benchmark::measure_in_child(const plugin_benchmark::module_info &mi, uint32_t srate, uint32_t block_size, sample &s)
+{
+    int fds[2];
+    if (pipe(fds) < 0) {
+        measure(mi, srate, block_size, s);
+        return true;
+    }
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        measure(mi, srate, block_size, s);
+        return true;
+    }
+    if (!pid) {
+        close(fds[0]);
+        measure(mi, srate, block_size, s);
+        bool ok = write(fds[1], &s, sizeof(s)) == (ssize_t)sizeof(s);
+        _exit(ok ? 0 : 1);
+    }
+    close(fds[1]);
+    ssize_t len = read(fds[0], &s, sizeof(s));
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return len == (ssize_t)sizeof(s) && WIFEXITED(status) && !WEXITSTATUS(status);
+}
+
+void footprint_benchmark::run()
+{
+    printf("%-20s %6s %9s %9s %9s %9s %9s   %s\n", "plugin", "srate", "create", "set_sr", "activate", "1st_proc", "teardown", "resident set growth [kB]");
+    for (unsigned int m = 0; m < sizeof(plugin_benchmark::modules) / sizeof(plugin_benchmark::modules[0]); m++) {
+        const plugin_benchmark::module_info &mi = plugin_benchmark::modules[m];
+        if (!plugin_benchmark::selected(mi))
+            continue;
+        for (unsigned int r = 0; r < sample_rates.size(); r++) {
+            result res;
+            res.plugin = mi.name;
+            res.sample_rate = sample_rates[r];
+            if (!measure_in_child(mi, res.sample_rate, block_sizes[0], res)) {
+                printf("%-20s %6u: failed\n", res.plugin.c_str(), res.sample_rate);
+                continue;
+            }
+            results.push_back(res);
+            printf("%-20s %6u %6.3f ms %6.3f ms %6.3f ms %6.3f ms %6.3f ms   %ld / %ld / %ld / %ld / %ld\n", res.plugin.c_str(), res.sample_rate,
+                res.create * 1000, res.set_sample_rate * 1000, res.activate * 1000, res.first_process * 1000, res.teardown * 1000,
+                res.rss_create >> 10, res.rss_set_sample_rate >> 10, res.rss_activate >> 10, res.rss_first_process >> 10, res.rss_teardown >> 10);
+            fflush(stdout);
+        }
+    }
+}
+
+void footprint_benchmark::write_json(FILE *f)
+{
+    fprintf(f, "{\n  \"version\": %s,\n  \"block_size\": %u,\n  \"results\": [\n", json_string(PACKAGE_STRING).c_str(), block_sizes[0]);
+    for (unsigned int i = 0; i < results.size(); i++) {
+        const result &r = results[i];
+        fprintf(f, "    {\"plugin\": %s, \"sample_rate\": %u, "
+            "\"create_ms\": %.4f, \"set_sample_rate_ms\": %.4f, \"activate_ms\": %.4f, \"first_process_ms\": %.4f, \"teardown_ms\": %.4f, "
+            "\"rss_create\": %ld, \"rss_set_sample_rate\": %ld, \"rss_activate\": %ld, \"rss_first_process\": %ld, \"rss_teardown\": %ld}%s\n",
+            json_string(r.plugin).c_str(), r.sample_rate,
+            r.create * 1000, r.set_sample_rate * 1000, r.activate * 1000, r.first_process * 1000, r.teardown * 1000,
+            r.rss_create, r.rss_set_sample_rate, r.rss_activate, r.rss_first_process, r.rss_teardown, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+}
+
+void footprint_test()
+{
+    footprint_benchmark bench;
+    bench.run();
+    write_json_file(bench);
+}
+
 #else
 void effect_test()
 {
     printf("Test temporarily removed due to refactoring\n");
 }
+
+void plugin_test()
+{
+    printf("Test temporarily removed due to refactoring\n");
+}
+
+void footprint_test()
+{
+    printf("Test temporarily removed due to refactoring\n");
+}
 #endif
 void reverbir_calc()
 {
@@ -509,13 +898,16 @@ int main(int argc, char *argv[])
 {
     while(1) {
         int option_index;
-        int c = getopt_long(argc, argv, "u:hv", long_options, &option_index);
+        int c = getopt_long(argc, argv, "u:p:j:P:r:b:s:n:hv", long_options, &option_index);
         if (c == -1)
             break;
         switch(c) {
             case 'h':
             case '?':
-                printf("Benchmark suite Calf plugin pack\nSyntax: %s [--help] [--version] [--unit biquad|alignment|effects]\n", argv[0]);
+                printf("Benchmark suite Calf plugin pack\nSyntax: %s [--help] [--version] [--unit biquad|alignment|effects|plugins|footprint]\n"
+                    "       [--plugin <name>] [--presets <presets.xml>] [--sample-rates <sr,...>] [--block-sizes <n,...>]\n"
+                    "       [--seconds <audio seconds per run>] [--runs <n>] [--json <file|->]\n"
+                    "The footprint unit processes a single block of the first block size.\n", argv[0]);
                 return 0;
             case 'v':
                 printf("%s\n", PACKAGE_STRING);
@@ -523,8 +915,47 @@ int main(int argc, char *argv[])
             case 'u':
                 unit = optarg;
                 break;
+            case 'p':
+                plugin_filter = optarg;
+                break;
+            case 'j':
+                json_name = optarg;
+                break;
+            case 'P':
+                presets_name = optarg;
+                break;
+            case 'r':
+            case 'b':
+            {
+                std::vector<uint32_t> &list = c == 'r' ? sample_rates : block_sizes;
+                list.clear();
+                for (char *p = optarg; *p; ) {
+                    uint32_t value = strtoul(p, &p, 10);
+                    if (value)
+                        list.push_back(value);
+                    if (*p)
+                        p++;
+                }
+                break;
+            }
+            case 's':
+                run_seconds = atof(optarg);
+                break;
+            case 'n':
+                run_count = std::max(1, atoi(optarg));
+                break;
         }
     }
+    if (sample_rates.empty()) {
+        sample_rates.push_back(44100);
+        sample_rates.push_back(48000);
+        sample_rates.push_back(96000);
+    }
+    if (block_sizes.empty()) {
+        block_sizes.push_back(32);
+        block_sizes.push_back(256);
+        block_sizes.push_back(1024);
+    }
     
 #ifdef TEST_OSC
     if (unit && !strcmp(unit, "osc"))
@@ -540,6 +971,13 @@ int main(int argc, char *argv[])
     if (!unit || !strcmp(unit, "effects"))
         effect_test();
 
+    // takes a few minutes, so only on request
+    if (unit && !strcmp(unit, "plugins"))
+        plugin_test();
+
+    if (unit && !strcmp(unit, "footprint"))
+        footprint_test();
+
     if (unit && !strcmp(unit, "reverbir"))
         reverbir_calc();
 
@@ -40,6 +40,23 @@ namespace calf_plugins {
 class analyzer: public frequency_response_line_graph
 {
 private:
+    /// Settings needed for drawing, published by the audio thread
+    struct settings {
+        int accuracy, acc, scale, post, hold, smooth, speed, windowing, view, freeze, mode;
+        float resolution, offset;
+        uint32_t srate;
+        /// incremented when the drawing buffers have to be cleared or the FFT plan recreated
+        unsigned int sanitize_serial, plan_serial;
+        settings();
+    };
+    /// current settings (audio thread)
+    settings params;
+    graph_snapshot<settings> params_snapshot;
+    void publish_params();
+    /// copy the latest published settings into the members below (GUI thread)
+    void fetch_params() const;
+    mutable unsigned int sanitize_seen, plan_seen;
+
     mutable int _accuracy;
     mutable int _acc;
     mutable int _scale;
@@ -63,7 +80,7 @@ public:
     using frequency_response_line_graph::get_gridline;
     using frequency_response_line_graph::get_layers;
 
-    uint32_t srate;
+    mutable uint32_t srate;
     analyzer();
     void process(float L, float R);
     void set_sample_rate(uint32_t sr);
@@ -81,7 +98,8 @@ protected:
     int fft_buffer_size;
     float *fft_buffer;
     int *spline_buffer;
-    int fpos;
+    /// write position in fft_buffer, only changed by process()
+    volatile int fpos;
     mutable bool sanitize, recreate_plan;
     static const int MAX_FFT_ORDER = 15;
     dsp::fft<float, MAX_FFT_ORDER> fft;
@@ -102,19 +102,32 @@ public:
 };
 
 /**
- * A monophonic phaser. If you want stereo, combine two :)
- * Also, gave up on using template args for signal type.
+ * A stereo phaser. Both channels share all the settings except for the
+ * LFO phase, and run through the allpass cascade together, as two lanes
+ * of the same loop. The allpass coefficient is recalculated every
+ * SubBlock samples and linearly interpolated in between.
  */
-class simple_phaser: public modulation_effect
+class stereo_phaser: public modulation_effect
 {
+public:
+    enum { MaxStages = 24, SubBlock = 32 };
 protected:
     float base_frq, mod_depth, fb;
-    float state;
-    int cnt, stages, max_stages;
-    dsp::onepole<float, float> stage1;
-    float *x1, *y1;
+    int stages;
+    /// samples left until the next control_step
+    int cnt;
+    /// LFO phase offset of the right channel
+    fixed_point<unsigned int, 20> r_phase;
+    /// current allpass coefficient and its per-sample increment, per lane
+    float a0[2], da0[2];
+    /// feedback state, per lane
+    float state[2];
+    /// z[0] is the last input of the cascade, z[i] is the last output
+    /// of stage i-1 (which is also the last input of stage i)
+    float z[MaxStages + 1][2];
+    float coeff_at(fixed_point<unsigned int, 20> ph) const;
 public:
-    simple_phaser(int _max_stages, float *x1vals, float *y1vals);
+    stereo_phaser();
 
     float get_base_frq() const {
         return base_frq;
@@ -140,6 +153,10 @@ public:
     void set_fb(float fb) {
         this->fb = fb;
     }
+    /// Set the LFO phase of the right channel relative to the left one (0-1)
+    void set_stereo_phase(float req_phase) {
+        r_phase = req_phase * 4096.0;
+    }
     
     virtual void setup(int sample_rate) {
         modulation_effect::setup(sample_rate);
@@ -147,8 +164,8 @@ public:
     }
     void reset();
     void control_step();
-    void process(float *buf_out, float *buf_in, int nsamples, bool active, float level_in = 1., float level_out = 1.);
-    float freq_gain(float freq, float sr) const;
+    void process(float *out_l, float *out_r, const float *in_l, const float *in_r, int nsamples, bool active, float level_in = 1., float level_out = 1.);
+    float freq_gain(int lane, float freq, float sr) const;
 };
 
 /**
@@ -633,6 +650,19 @@ public:
 
 class crossover {
 private:
+    /// Copy of everything get_graph() needs, published by the audio thread
+    struct graph_state {
+        int bands, filters;
+        uint32_t srate;
+        float level[8];
+        bool active[8];
+        dsp::biquad_coeffs lp[8][4], hp[8][4];
+        graph_state() : bands(0), filters(1), srate(44100) {}
+    };
+    calf_plugins::graph_snapshot<graph_state> graph;
+    void publish_graph();
+    /// Recalculate the coefficients of band b without publishing them, returns false if nothing changed
+    bool update_filter(int b, float f, bool force);
 public:
     int channels, bands, mode;
     float freq[8], active[8], level[8], out[8][8];
@@ -710,10 +740,20 @@ private:
     float blend_old, drive_old;
     float meter;
     float rdrive, rbdr, kpa, kpb, kna, knb, ap, an, imr, kc, srct, sq, pwrq;
-    int over;
+    int over, quality;
     float prev_med, prev_out;
+    /// ADAA state: previous shaper input and the antiderivative at that point
+    double prev_x, prev_F;
+    /// ADAA constants: centre and radius of the quadratics under the square roots, and their integrals from 0
+    double hp, rp, hn, rn, p0p, p0n;
     resampleN resampler;
+    float shape(float proc) const;
+    double antiderivative(double x) const;
+    float shape_adaa(float proc);
+    static double sqrt_abs_integral(double u, double r);
 public:
+    /// Quality modes: original 2x oversampling, antiderivative antialiasing without and with 2x oversampling
+    enum { quality_oversampled, quality_adaa, quality_adaa_2x, quality_count };
     uint32_t srate;
     bool is_active;
     tap_distortion();
@@ -721,6 +761,8 @@ public:
     void deactivate();
     void set_params(float blend, float drive);
     void set_sample_rate(uint32_t sr);
+    /// Select one of the quality modes (quality_oversampled is the default)
+    void set_quality(int q);
     float process(float in);
     float get_distortion_level();
     static inline float M(float x)
@@ -798,6 +840,66 @@ public:
     }
 };
 
+/// Stereo sample loaded from a SoundFont 2 file (one left and one right sample, as
+/// in the Vinyl noise layers). Only the sample data is kept in memory, it is read
+/// completely in open(), so that playback never waits for the disk.
+class sf2_stereo_sample
+{
+private:
+    /// Left channel, followed by the right channel (length frames each)
+    int16_t *frames;
+    const int16_t *data[2];
+    /// Locate the samples within the SF2 file and copy them
+    bool parse(const uint8_t *file, size_t file_size);
+public:
+    /// Sample length, loop start and loop end (exclusive) in frames
+    uint32_t length, loop_start, loop_end;
+    /// Sample rate the sample has been recorded at
+    uint32_t sample_rate;
+
+    sf2_stereo_sample();
+    ~sf2_stereo_sample();
+    /// Load the samples from the file, returns false if the file is missing or invalid
+    bool open(const char *path);
+    void close();
+    bool is_open() const { return frames != NULL; }
+    inline float get(int channel, uint32_t pos) const
+    {
+        return data[channel][pos] * (1.f / 32768.f);
+    }
+};
+
+/// Process-wide, reference counted cache of loaded sf2_stereo_samples, keyed by path,
+/// so that all plugin instances share one copy of the sample data
+class sf2_sample_cache
+{
+public:
+    /// Return a reference to the samples of a file, loading it if necessary; NULL if it cannot be loaded
+    static const sf2_stereo_sample *acquire(const char *path);
+    /// Release a reference obtained from acquire
+    static void release(const sf2_stereo_sample *sample);
+};
+
+/// Looped playback of a sf2_stereo_sample, with variable speed and gain
+/// smoothed over each rendered block
+class sample_layer
+{
+private:
+    const sf2_stereo_sample *sample;
+    double pos, step;
+    float gain, target_gain;
+public:
+    sample_layer();
+    void set_sample(const sf2_stereo_sample *s);
+    /// Set playback speed (1 = original pitch) for output sample rate sr
+    void set_speed(double ratio, uint32_t sr);
+    void set_gain(float g) { target_gain = g; }
+    /// True if the layer produces any output
+    bool is_audible() const { return sample && (gain > 0.f || target_gain > 0.f); }
+    /// Mix nsamples of the layer into left and right
+    void render_to(float *left, float *right, uint32_t nsamples);
+};
+
 #if 0
 { to keep editor happy
 #endif
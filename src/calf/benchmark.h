@@ -21,6 +21,7 @@
 #ifndef __CALF_BENCHMARK_H
 #define __CALF_BENCHMARK_H
 
+#include <stdio.h>
 #include <time.h>
 #include <sys/time.h>
 #include <sys/resource.h>
@@ -86,6 +87,27 @@ inline uint64_t rdtsc()
 }
 #endif
 
+/// Monotonic wall clock time in seconds, with (usually) nanosecond resolution
+inline double benchmark_clock()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/// Resident set size of the current process in bytes, 0 if unknown
+inline long resident_memory()
+{
+    long size = 0, resident = 0;
+    FILE *f = fopen("/proc/self/statm", "r");
+    if (!f)
+        return 0;
+    if (fscanf(f, "%ld %ld", &size, &resident) != 2)
+        resident = 0;
+    fclose(f);
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
 struct benchmark_globals
 {
     static bool warned;
@@ -114,13 +136,17 @@ public:
                 warned = true;
             }
         }
+        // warm up caches, branch predictors and CPU frequency scaling
+        target.prepare();
+        for (int j = 0; j < repeats / 10 + 1; j++)
+            target.run();
+        target.cleanup();
         for (int i = 0; i < runs; i++) {
             target.prepare();
-            // XXXKF measuring CPU time with clock() sucks, 
 #if USE_RDTSC
             uint64_t start = rdtsc();
 #else
-            clock_t start = ::clock();
+            double start = benchmark_clock();
 #endif
             for (int j = 0; j < repeats; j++) {
                 target.run();
@@ -129,8 +155,8 @@ public:
             uint64_t end = rdtsc();
             double elapsed = double(end - start) / (CLOCK_SPEED * repeats * target.scaler());
 #else
-            clock_t end = ::clock();
-            double elapsed = double(end - start) / (double(CLOCKS_PER_SEC) * repeats * target.scaler());
+            double end = benchmark_clock();
+            double elapsed = (end - start) / (repeats * target.scaler());
 #endif
             stat.add(elapsed);
             target.cleanup();
@@ -581,6 +581,67 @@ struct biquad_d1_lerp: public biquad_coeffs
     }
     
 };
+
+/**
+ * L direct form II biquads with separate coefficients, run side by side
+ * (eg. left and right channel, or several bands of the same channel).
+ * The loop over lanes has no dependencies between iterations, so the
+ * compiler can vectorize it. Unlike biquad_d2, the state is not
+ * sanitized per sample - call sanitize() once per block.
+ */
+template<int L>
+struct biquad_d2_lanes
+{
+    double a0[L], a1[L], a2[L], b1[L], b2[L];
+    /// state[n-1]
+    double w1[L];
+    /// state[n-2]
+    double w2[L];
+    biquad_d2_lanes()
+    {
+        for (int l = 0; l < L; l++)
+            set_lane(l, biquad_coeffs());
+        reset();
+    }
+    /// Copy coefficients of lane l from a regular biquad
+    inline void set_lane(int l, const biquad_coeffs &src)
+    {
+        a0[l] = src.a0;
+        a1[l] = src.a1;
+        a2[l] = src.a2;
+        b1[l] = src.b1;
+        b2[l] = src.b2;
+    }
+    /// Filter one sample of every lane in place
+    inline void process(double *inout)
+    {
+        for (int l = 0; l < L; l++)
+        {
+            double tmp = inout[l] - w1[l] * b1[l] - w2[l] * b2[l];
+            inout[l] = tmp * a0[l] + w1[l] * a1[l] + w2[l] * a2[l];
+            w2[l] = w1[l];
+            w1[l] = tmp;
+        }
+    }
+    /// Sanitize (set to 0 if potentially denormal) filter state
+    inline void sanitize()
+    {
+        for (int l = 0; l < L; l++)
+        {
+            dsp::sanitize(w1[l]);
+            dsp::sanitize(w2[l]);
+        }
+    }
+    /// Reset state variables
+    inline void reset()
+    {
+        for (int l = 0; l < L; l++)
+        {
+            dsp::zero(w1[l]);
+            dsp::zero(w2[l]);
+        }
+    }
+};
     
 /// Compose two filters in series
 template<class F1, class F2>
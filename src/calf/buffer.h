@@ -21,6 +21,11 @@
 #ifndef __BUFFER_H
 #define __BUFFER_H
 
+#include <new>
+#include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+
 namespace dsp {
 
 /// decrease by N if >= N (useful for circular buffers)
@@ -148,6 +153,48 @@ public:
     }    
 }; 
 
+/// Buffer in anonymous mapped memory. The pages read as zero and only take
+/// up RAM once written to, so it can be sized for the worst case without
+/// clearing it or paying for the part that is never used.
+template<class T = float>
+class mapped_buffer {
+    T *buf;
+    size_t buf_size;
+    mapped_buffer(const mapped_buffer &);
+    mapped_buffer &operator=(const mapped_buffer &);
+public:
+    mapped_buffer() : buf(NULL), buf_size(0) {}
+    /// Replace the contents with new_size zeroed elements
+    void allocate(size_t new_size) {
+        release();
+        if (!new_size)
+            return;
+        void *ptr = mmap(NULL, new_size * sizeof(T), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (ptr == MAP_FAILED)
+            throw std::bad_alloc();
+        buf = (T *)ptr;
+        buf_size = new_size;
+    }
+    void release() {
+        if (buf)
+            munmap(buf, buf_size * sizeof(T));
+        buf = NULL;
+        buf_size = 0;
+    }
+    /// Zero count elements starting from pos
+    void clear(size_t pos, size_t count) {
+        memset(buf + pos, 0, count * sizeof(T));
+    }
+    inline T* data() { return buf; }
+    inline const T* data() const { return buf; }
+    inline size_t size() const { return buf_size; }
+    inline T& operator[](int pos) { return buf[pos]; }
+    inline const T& operator[](int pos) const { return buf[pos]; }
+    ~mapped_buffer() {
+        release();
+    }
+};
+
 template<class T, class U>
 void copy_buf(T &dest_buf, const U &src_buf, T scale = 1, T add = 0) {
     typedef typename T::data_type data_type;
@@ -37,7 +37,11 @@ public:
         {
             float *out = outputs[b] + offset, *in = inputs[b] + offset;
             if (first_value >= 1 && next_value >= 1)
-                memcpy(out, in, nsamples * sizeof(float));
+            {
+                // nothing to do if the host processes in place
+                if (out != in)
+                    memcpy(out, in, nsamples * sizeof(float));
+            }
             else
             {
                 for (uint32_t i = 0; i < nsamples; ++i)
@@ -94,12 +94,16 @@ struct CalfLineGraph
     float zoom, offset;
     int param_zoom, param_offset;
     
+    /// shared between all graphs with the same size and style, never drawn on after creation
     cairo_surface_t *background_surface;
     cairo_surface_t *grid_surface;
     cairo_surface_t *cache_surface;
     cairo_surface_t *moving_surface[2];
     cairo_surface_t *handles_surface;
     cairo_surface_t *realtime_surface;
+    /// buffer handed to get_graph/get_moving, kept between exposes
+    float *graph_data;
+    int graph_data_size;
 
     // crosshairs and FreqHandles
     gdouble mouse_x, mouse_y;
@@ -114,6 +114,28 @@ struct simple_delay {
         return lerp(data[ppos], data[pppos], udelay);
     }
     
+    /** Read one sample at fractional position using 4-point, 3rd order
+     * Hermite interpolation. Sounds cleaner than get_interp_1616 when the
+     * read position is modulated, at the cost of two more reads.
+     * The point after the position (towards the newest sample) is only
+     * available for delays of at least 2 samples, shorter delays
+     * repeat the nearest sample instead.
+     * @param delay delay relative to current writing pos, 16.16 fixed point
+     */
+    inline T get_interp_hermite_1616(unsigned int delay) {
+        float t = (float)((delay & 0xFFFF) * (1.0 / 65536.0));
+        delay = delay >> 16;
+        int p0 = wrap_around<N>(pos + N - delay);
+        int pm1 = delay > 1 ? wrap_around<N>(p0 + 1) : p0;
+        int p1 = wrap_around<N>(p0 + N - 1);
+        int p2 = wrap_around<N>(p0 + N - 2);
+        T xm1 = data[pm1], x0 = data[p0], x1 = data[p1], x2 = data[p2];
+        T c1 = 0.5f * (x1 - xm1);
+        T c2 = xm1 - 2.5f * x0 + 2.f * x1 - 0.5f * x2;
+        T c3 = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+        return ((c3 * t + c2) * t + c1) * t + x0;
+    }
+    
     /**
      * Comb filter. Feedback delay line with given delay and feedback values
      * @param in input signal
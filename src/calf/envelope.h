@@ -134,21 +134,22 @@ public:
         }
     }
     /// Calculate next envelope value
-    inline void advance()
+    /// @param step length of the step relative to the envelope update period (less than 1 for partial blocks)
+    inline void advance(double step = 1.0)
     {
         old_value = value;
         // XXXKF This may use a state array instead of a switch some day (at least for phases other than attack and possibly sustain)
         switch(state)
         {
         case ATTACK:
-            value += attack;
+            value += attack * step;
             if (value >= 1.0) {
                 value = 1.0;
                 state = DECAY;
             }
             break;
         case DECAY:
-            value -= decay;
+            value -= decay * step;
             if (value < sustain)
             {
                 value = sustain;
@@ -156,7 +157,7 @@ public:
             }
             break;
         case LOCKDECAY:
-            value -= decay;
+            value -= decay * step;
             if (value < sustain)
             {
                 if (value < 0.f)
@@ -168,7 +169,7 @@ public:
         case SUSTAIN:
             if (fade != 0.f)
             {
-                value -= fade;
+                value -= fade * step;
                 if (value > 1.f)
                     value = 1.f;
             }
@@ -180,7 +181,7 @@ public:
             }
             break;
         case RELEASE:
-            value -= thisrelease;
+            value -= thisrelease * step;
             if (value <= 0.f) {
                 value = 0.f;
                 state = STOP;
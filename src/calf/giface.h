@@ -35,7 +35,9 @@ namespace osctl {
 namespace calf_plugins {
 
 enum {
-    MAX_SAMPLE_RUN = 256
+    MAX_SAMPLE_RUN = 256,
+    /// Number of samples between control_tick() calls for modules that don't need anything else
+    DEFAULT_CONTROL_PERIOD = 32
 };
 
 struct automation_range;
@@ -156,6 +158,36 @@ struct parameter_properties
     float get_increment() const;
 };
 
+/// parameter_properties::from_01/to_01 with the constants that only depend on
+/// the range (like log(max / min)) calculated once - for converting values
+/// often, eg. in GUI controls or when building MIDI controller tables;
+/// the scales have to stay the same as in parameter_properties
+struct parameter_mapping
+{
+    /// PF_SCALE_* value
+    uint32_t scale;
+    /// round the result of from_01 to an integer
+    bool integer;
+    /// minimum and maximum value
+    float min, max;
+    /// bottom of the scale: min, except for PF_SCALE_GAIN where it's limited to -60 dB
+    double base;
+    /// max - min for the linear scales, log(max / base) for the logarithmic ones
+    double range, inv_range;
+    /// PF_SCALE_LOG_INF: part of the [0, 1] range below the infinity step
+    double finite_part, inv_finite_part;
+
+    parameter_mapping() {}
+    explicit parameter_mapping(const parameter_properties &props) { init(props); }
+    void init(const parameter_properties &props);
+    /// convert from [0, 1] range to [min, max] (applying scaling)
+    float from_01(double value01) const;
+    /// convert from [min, max] to [0, 1] range (applying reverse scaling)
+    double to_01(float value) const;
+    /// fill values[0..127] with the values for 7-bit controller positions spread over [min01, max01]
+    void fill_cc_table(float *values, double min01 = 0, double max01 = 1) const;
+};
+
 struct cairo_iface
 {
     int size_x, size_y, pad_x, pad_y;
@@ -193,6 +225,49 @@ enum moving_directions {
     LG_MOVING_DOWN     = 0x000004
 };
 
+/// Lock-free slot (triple buffer) for passing state from one thread to another,
+/// eg. graph-relevant state from the audio thread to the GUI thread. The writer
+/// fills get_write() and calls publish(); the reader only looks at get_read(),
+/// which returns the latest published copy and never sees a half-written one.
+/// State must be rewritten completely before each publish().
+template<class State>
+class graph_snapshot
+{
+    State slots[3];
+    /// slot owned by the writer
+    int write_idx;
+    /// slot owned by the reader
+    mutable int read_idx;
+    /// slot in between, with fresh_bit set if it is newer than the reader's
+    mutable volatile int middle;
+    enum { fresh_bit = 4 };
+public:
+    graph_snapshot() : write_idx(0), read_idx(1), middle(2) {}
+    /// All three copies, only for setting up State before the snapshot is shared between threads
+    State &get_slot(int i) { return slots[i]; }
+    /// State to be filled in by the writer (writer thread only)
+    State &get_write() { return slots[write_idx]; }
+    /// Make the state filled in via get_write() visible to the reader (writer thread only)
+    void publish() {
+        int old;
+        do {
+            old = middle;
+        } while(!__sync_bool_compare_and_swap(&middle, old, write_idx | fresh_bit));
+        write_idx = old & ~fresh_bit;
+    }
+    /// Most recently published state (reader thread only)
+    const State &get_read() const {
+        if (middle & fresh_bit) {
+            int old;
+            do {
+                old = middle;
+            } while(!__sync_bool_compare_and_swap(&middle, old, read_idx));
+            read_idx = old & ~fresh_bit;
+        }
+        return slots[read_idx];
+    }
+};
+
 /// 'provides live line graph values' interface
 struct line_graph_iface
 {
@@ -330,7 +405,7 @@ struct ladspa_plugin_info
 /// An interface returning metadata about a plugin
 struct plugin_metadata_iface
 {
-    enum { simulate_stereo_input = true, has_live_updates = true };
+    enum { simulate_stereo_input = true, has_live_updates = true, in_place_safe = false };
     /// @return plugin long name
     virtual const char *get_name() const = 0;
     /// @return plugin LV2 label
@@ -363,6 +438,8 @@ struct plugin_metadata_iface
     virtual plugin_command_info *get_commands() const { return NULL; }
     /// @return description structure for given parameter
     virtual const parameter_properties *get_param_props(int param_no) const = 0;
+    /// @return precalculated scaling for given parameter
+    virtual const parameter_mapping *get_param_mapping(int param_no) const = 0;
     /// @return retrieve names of audio ports (@note control ports are named in parameter_properties, not here)
     virtual const char **get_port_names() const = 0;
     /// @return description structure for the plugin
@@ -527,14 +604,27 @@ public:
     float *params[Metadata::param_count];
     bool questionable_data_reported_in;
     bool questionable_data_reported_out;
+    /// Number of samples between control_tick() calls, 0 = no control rate processing
+    uint32_t control_period;
+    /// Samples left until the next control_tick()
+    uint32_t control_left;
+    /// Private copies of the inputs for process() calls where the host passes the same buffer
+    /// as an input and an output, only used if the module is not marked as in_place_safe
+    float input_copies[(Metadata::in_count != 0 && !Metadata::in_place_safe) ? Metadata::in_count : 1][(Metadata::in_count != 0 && !Metadata::in_place_safe) ? MAX_SAMPLE_RUN : 1];
+    /// Number of samples of digital silence on all inputs so far, see get_tail_length
+    uint32_t silent_samples;
 
     progress_report_iface *progress_report;
 
     audio_module() {
         progress_report = NULL;
+        control_period = 0;
+        control_left = 0;
+        silent_samples = 0;
         memset(ins, 0, sizeof(ins));
         memset(outs, 0, sizeof(outs));
         memset(params, 0, sizeof(params));
+        memset(input_copies, 0, sizeof(input_copies));
         questionable_data_reported_in = false;
         questionable_data_reported_out = false;
     }
@@ -573,6 +663,21 @@ public:
     void params_reset() {}
     /// Called after instantiating (after all the feature pointers are set - including interfaces like progress_report_iface)
     void post_instantiate(uint32_t) {}
+    /// Called every control_period samples before the audio that follows is processed, so that
+    /// coefficient calculations run at a fixed rate whatever the host block size is. Values that
+    /// need interpolating between the ticks can be fed to dsp::inertia<dsp::linear_ramp> (or
+    /// gain_smoothing) with a ramp of control_period samples.
+    virtual void control_tick() {}
+    /// Number of samples after the inputs fall silent until the outputs (including the meters) settle
+    /// down - reverb decay, delay feedback, release times. Once the inputs have been silent for longer
+    /// than that, process_slice stops calling process() and outputs silence until the inputs come
+    /// back. -1 (default) = never suspend the module, eg. because it generates sound by itself.
+    virtual int get_tail_length() const { return -1; }
+    /// Call control_tick() every period samples (0 = never), starting with the next process_slice
+    void set_control_period(uint32_t period) {
+        control_period = period;
+        control_left = 0;
+    }
     /// Handle 'message context' port message
     /// @arg output_ports pointer to bit array of output port "changed" flags, note that 0 = first audio input, not first parameter (use input_count + output_count)
     uint32_t message_run(const void *valid_ports, void *output_ports) {
@@ -600,16 +705,63 @@ public:
             }
         }
     }
-    /// utility function: call process, and if it returned zeros in output masks, zero out the relevant output port buffers
+    /// utility function: check if any of the input buffers is also an output buffer, and the module can't handle that
+    inline bool inputs_aliased() const
+    {
+        if (Metadata::in_place_safe)
+            return false;
+        for (int i=0; i<Metadata::in_count; ++i) {
+            if (!ins[i])
+                continue;
+            for (int j=0; j<Metadata::out_count; ++j) {
+                if (ins[i] == outs[j])
+                    return true;
+            }
+        }
+        return false;
+    }
+    /// utility function: call process on private copies of the aliased inputs (nsamples <= MAX_SAMPLE_RUN), so
+    /// that the module can read them after writing the outputs (input meters, bypass crossfades etc.)
+    uint32_t process_copied_inputs(uint32_t offset, uint32_t nsamples)
+    {
+        float *orig_ins[sizeof(ins) / sizeof(ins[0])], *orig_outs[sizeof(outs) / sizeof(outs[0])];
+        memcpy(orig_ins, ins, sizeof(ins));
+        memcpy(orig_outs, outs, sizeof(outs));
+        for (int i=0; i<Metadata::in_count; ++i) {
+            if (!ins[i])
+                continue;
+            bool aliased = false;
+            for (int j=0; j<Metadata::out_count; ++j)
+                aliased = aliased || ins[i] == outs[j];
+            if (aliased) {
+                memcpy(input_copies[i], ins[i] + offset, nsamples * sizeof(float));
+                ins[i] = input_copies[i];
+            }
+            else
+                ins[i] += offset;
+        }
+        for (int j=0; j<Metadata::out_count; ++j) {
+            if (outs[j])
+                outs[j] += offset;
+        }
+        uint32_t out_mask = process(0, nsamples, -1, -1);
+        memcpy(ins, orig_ins, sizeof(ins));
+        memcpy(outs, orig_outs, sizeof(outs));
+        return out_mask;
+    }
+    /// utility function: call process (split at control ticks, see control_tick, and on copies of the inputs if needed; not at all
+    /// while suspended, see get_tail_length), and if it returned zeros in output masks, zero out the relevant output port buffers
     uint32_t process_slice(uint32_t offset, uint32_t end)
     {
-        bool had_errors = false;
+        bool had_errors = false, silent = true;
         for (int i=0; i<Metadata::in_count; ++i) {
             float *indata = ins[i];
             if (indata) {
                 float errval = 0;
                 for (uint32_t j = offset; j < end; j++)
                 {
+                    if (indata[j] != 0)
+                        silent = false;
                     if (!std::isfinite(indata[j]) || fabs(indata[j]) > 4294967296.0) {
                         errval = indata[j];
                         had_errors = true;
@@ -621,11 +773,32 @@ public:
                 }
             }
         }
+        int tail = get_tail_length();
+        if (tail >= 0) {
+            if (!silent)
+                silent_samples = 0;
+            else if (silent_samples > (uint32_t)tail) {
+                // the tail has decayed, nothing to do until the input comes back
+                zero_by_mask(0, offset, end - offset);
+                return 0;
+            }
+            else
+                silent_samples += end - offset;
+        }
         uint32_t total_out_mask = 0;
+        bool aliased = inputs_aliased();
         while(offset < end)
         {
             uint32_t newend = std::min(offset + MAX_SAMPLE_RUN, end);
-            uint32_t out_mask = !had_errors ? process(offset, newend - offset, -1, -1) : 0;
+            if (control_period) {
+                if (!control_left) {
+                    control_tick();
+                    control_left = control_period;
+                }
+                newend = std::min(newend, offset + control_left);
+                control_left -= newend - offset;
+            }
+            uint32_t out_mask = had_errors ? 0 : (aliased ? process_copied_inputs(offset, newend - offset) : process(offset, newend - offset, -1, -1));
             total_out_mask |= out_mask;
             zero_by_mask(out_mask, offset, newend - offset);
             offset = newend;
@@ -699,6 +872,17 @@ struct dssi_feedback_sender
 };
 #endif
 
+/// parameter_mapping for every parameter of a plugin
+template<int ParamCount>
+struct parameter_mapping_table
+{
+    parameter_mapping mappings[ParamCount];
+    parameter_mapping_table(const parameter_properties *props) {
+        for (int i = 0; i < ParamCount; i++)
+            mappings[i].init(props[i]);
+    }
+};
+
 /// Metadata base class template, to provide default versions of interface functions
 template<class Metadata>
 class plugin_metadata: public plugin_metadata_iface
@@ -728,6 +912,11 @@ public:
     char *get_gui_xml(const char *prefix) const { char xmlf[64]; sprintf(xmlf, "%s/%s", prefix, get_id()); char *data_ptr = calf_plugins::load_gui_xml(xmlf); return data_ptr; }
     plugin_command_info *get_commands() const { return NULL; }
     const parameter_properties *get_param_props(int param_no) const { return &param_props[param_no]; }
+    const parameter_mapping *get_param_mapping(int param_no) const {
+        // built on first use, from the GUI or the host's (non-RT) setup code
+        static const parameter_mapping_table<Metadata::param_count> table(param_props);
+        return &table.mappings[param_no];
+    }
     const char **get_port_names() const { return port_names; }
     bool is_cv(int param_no) const { return true; }
     bool is_noisy(int param_no) const { return false; }
@@ -754,18 +943,62 @@ static inline float dB_grid(float amp, float res = 256, float ofs = 0.4)
     return log(amp) * (1.0 / log(res)) + ofs;
 }
 
+/// Logarithmic 20 Hz - 20 kHz frequency grid used by frequency response graphs,
+/// with cos/sin of w and 2w (for evaluating H(z) of biquads) for a given sample rate
+struct freq_response_grid
+{
+    int points;
+    float srate;
+    /// Frequency of each point
+    std::vector<double> freq;
+    /// cos(w), sin(w), cos(2w), sin(2w) for each point (empty if srate is 0)
+    std::vector<double> cw, sw, cw2, sw2;
+    void init(int _points, float _srate);
+    /// Return a shared grid for the given number of points and sample rate (0 = frequencies only)
+    static const freq_response_grid &get(int points, float srate = 0);
+};
+
+/// Frequency response of a cascade of biquads, evaluated over the whole grid in
+/// one pass and recalculated only when the grid or any of the coefficients change
+class biquad_response_cache
+{
+    /// a0, a1, a2, b1, b2, number of times applied for each stage
+    std::vector<double> stages, old_stages;
+    const freq_response_grid *grid, *old_grid;
+    std::vector<float> gains;
+public:
+    biquad_response_cache() : grid(NULL), old_grid(NULL) {}
+    /// Start describing the cascade
+    void begin(const freq_response_grid &g) { grid = &g; stages.clear(); }
+    /// Add a filter stage (applied 'times' times, like in 24 dB/oct modes)
+    template<class Coeffs>
+    void add(const Coeffs &c, int times = 1)
+    {
+        if (times <= 0)
+            return;
+        double st[6] = { c.a0, c.a1, c.a2, c.b1, c.b2, (double)times };
+        stages.insert(stages.end(), st, st + 6);
+    }
+    /// Return the gain for each point of the grid
+    const float *get();
+};
+
 template<class Fx>
 static bool get_graph(Fx &fx, int subindex, float *data, int points, float res = 256, float ofs = 0.4)
 {
+    const freq_response_grid &grid = freq_response_grid::get(points);
     for (int i = 0; i < points; i++)
-    {
-        //typedef std::complex<double> cfloat;
-        double freq = 20.0 * pow (20000.0 / 20.0, i * 1.0 / points);
-        data[i] = dB_grid(fx.freq_gain(subindex, freq), res, ofs);
-    }
+        data[i] = dB_grid(fx.freq_gain(subindex, grid.freq[i]), res, ofs);
     return true;
 }
 
+/// Convert a whole response curve to grid values
+static inline void dB_grid(float *data, const float *gains, int points, float res = 256, float ofs = 0.4)
+{
+    for (int i = 0; i < points; i++)
+        data[i] = dB_grid(gains[i], res, ofs);
+}
+
 /// convert normalized grid-ish value back to amplitude value
 static inline float dB_grid_inv(float pos, float res = 256, float ofs = 0.4)
 {
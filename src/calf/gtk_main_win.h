@@ -52,8 +52,10 @@ namespace calf_plugins {
         plugin_gui_window *gui_win;
         plugin_gui_widget *gui_widget;
         calf_connector *connector;
-        GtkWidget *strip_table, *name, *entry, *button, *con, *midi_in, *extra, *leftBG, *rightBG, *inBox, *outBox;
+        GtkWidget *strip_table, *name, *entry, *button, *con, *midi_in, *extra, *leftBG, *rightBG, *inBox, *outBox, *load;
         std::vector<GtkWidget *> audio_in, audio_out;
+        /// serial of the DSP load statistics shown in load
+        uint32_t load_serial;
         
         plugin_strip()
         : id()
@@ -73,11 +75,13 @@ namespace calf_plugins {
         , rightBG()
         , inBox()
         , outBox()
+        , load()
+        , load_serial()
         {}
         
     };
     
-    class gtk_main_window: public main_window_iface, public gui_environment, public calf_utils::config_listener_iface
+    class gtk_main_window: public main_window_iface, public gui_environment, public calf_utils::config_listener_iface, public gui_refresh_scheduler::client_iface
     {
     public:
         struct add_plugin_params
@@ -99,20 +103,23 @@ namespace calf_plugins {
         std::vector<jack_host *> plugin_queue;
         bool is_closed;
         bool draw_rackmounts;
-        int source_id;
+        bool scheduled;
         main_window_owner_iface *owner;
         calf_utils::config_notifier_iface *notifier;
         window_state winstate;
         
     protected:
         GtkWidget *progress_window;
-        window_update_controller refresh_controller;
     
     protected:
         plugin_strip *create_strip(jack_host *plugin);
         void update_strip(plugin_ctl_iface *plugin);
         void sort_strips();
-        static gboolean on_idle(void *data);
+        virtual bool on_frame();
+        /// runs the owner's idle processing, which must not be delayed or skipped
+        virtual void on_tick();
+        /// on_frame checks the visibility of the toplevel window itself
+        virtual GtkWidget *get_frame_widget() { return NULL; }
         std::string make_plugin_list(GtkActionGroup *actions);
         static void add_plugin_action(GtkWidget *src, gpointer data);
         void display_error(const char *error, const char *filename);
@@ -32,12 +32,51 @@
 
 namespace calf_plugins {
 
-class window_update_controller
+/// Single frame clock driving the periodic updates of all plugin GUIs in the
+/// process. Hidden and minimized clients are skipped, clients whose content
+/// hasn't changed for a while are updated less often, and a frame stops early
+/// when the frame budget is used up (the remaining clients go first in the
+/// next frame). Work that must not be delayed goes into on_tick.
+class gui_refresh_scheduler
 {
-    int refresh_counter;
 public:
-    window_update_controller() : refresh_counter() {}
-    bool check_redraw(GtkWidget *toplevel);
+    struct client_iface
+    {
+        /// Update the GUI, return true if anything has changed
+        virtual bool on_frame() = 0;
+        /// Widget that has to be visible for on_frame to be called (NULL - always call)
+        virtual GtkWidget *get_frame_widget() = 0;
+        /// Called on every timer tick, whether or not on_frame is called in that frame
+        virtual void on_tick() {}
+        virtual ~client_iface() {}
+    };
+    static gui_refresh_scheduler &get();
+    void add_client(client_iface *client);
+    void remove_client(client_iface *client);
+    /// Set the number of frames per second
+    void set_frame_rate(int fps);
+    /// Set the maximum time spent in a single frame, in milliseconds
+    void set_frame_budget(int ms);
+    /// Is the widget drawable and its toplevel window not minimized?
+    static bool is_visible(GtkWidget *widget);
+private:
+    struct client_data
+    {
+        client_iface *client;
+        /// number of consecutive updates without any change
+        int static_frames;
+        /// frames to skip before the next update
+        int wait;
+    };
+    std::vector<client_data> clients;
+    unsigned int next_client;
+    bool in_frame;
+    guint source_id;
+    int frame_rate, frame_budget;
+    gui_refresh_scheduler();
+    void restart();
+    void on_frame();
+    static gboolean on_timer(void *data);
 };
 
 
@@ -106,6 +145,7 @@ public:
     
     param_control();
     inline const parameter_properties &get_props();
+    inline const parameter_mapping &get_mapping();
     
     virtual GtkWidget *create(plugin_gui *_gui);
     /// called to create a widget for a control
@@ -174,6 +214,8 @@ public:
     preset_access_iface *preset_access;
     std::vector<param_control *> params;
     std::vector<int> read_serials;
+    /// output parameter values seen by the last on_idle call
+    std::vector<float> output_values;
     
     /* For optional lv2ui:show interface. */
     bool optclosed;
@@ -196,7 +238,8 @@ public:
     void send_configure(const char *key, const char *value);
     /// Called on change of status variable
     void send_status(const char *key, const char *value);
-    void on_idle();
+    /// Periodic update, returns true if any parameter, output value or status variable has changed
+    bool on_idle();
     /// Get a radio button group (if it exists) for a parameter
     GSList *get_radio_group(int param);
     /// Set a radio button group for a parameter
@@ -322,13 +365,12 @@ struct window_state {
     int x, y, width, height;
 };
 
-class plugin_gui_widget: public calf_utils::config_listener_iface
+class plugin_gui_widget: public calf_utils::config_listener_iface, public gui_refresh_scheduler::client_iface
 {
 private:
-    window_update_controller refresh_controller;
-    int source_id;
-private:
-    static gboolean on_idle(void *data);
+    bool scheduled;
+    virtual bool on_frame();
+    virtual GtkWidget *get_frame_widget() { return container; }
 protected:
     void create_gui(plugin_ctl_iface *_jh);
     static void on_window_destroyed(GtkWidget *window, gpointer data);
@@ -382,6 +424,11 @@ inline const parameter_properties &param_control::get_props()
     return  *gui->plugin->get_metadata_iface()->get_param_props(param_no);
 }
 
+inline const parameter_mapping &param_control::get_mapping()
+{
+    return *gui->plugin->get_metadata_iface()->get_param_mapping(param_no);
+}
+
 class null_audio_module;
 
 struct activate_command_params
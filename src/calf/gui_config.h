@@ -83,6 +83,10 @@ struct gui_config
     bool vu_meters;
     bool win_to_tray;
     bool win_start_hidden;
+    /// GUI updates per second
+    int refresh_rate;
+    /// maximum time spent on GUI updates per frame, in ms
+    int frame_budget;
     std::string style;
     
     gui_config();
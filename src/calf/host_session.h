@@ -70,6 +70,8 @@ public:
     std::string jack_session_id;
     /// Command used to start the JACK host
     std::string calfjackhost_cmd;
+    /// File to write the DSP load statistics of all plugins to on exit ("-" for stdout), empty for none
+    std::string load_report_name;
     
     // these are not saved
     jack_client client;
@@ -104,6 +106,9 @@ public:
     /// Client name for window title bar
     std::string get_client_name() const;
     
+    /// Write DSP load statistics of all plugins to load_report_name
+    void write_load_report();
+    
 public:
     /// Implementation of open file functionality (TODO)
     virtual char *open_file(const char *name);
@@ -28,6 +28,8 @@
 #include "utils.h"
 #include "vumeter.h"
 #include <pthread.h>
+#include <string.h>
+#include <time.h>
 #include <jack/jack.h>
 #include <jack/session.h>
 
@@ -47,13 +49,115 @@ struct automation_iface
     virtual ~automation_iface() {}
 };
 
+/// A controller change from the automation port, decoded once per cycle
+/// and shared by all plugins
+struct automation_event
+{
+    uint32_t time;
+    /// (channel << 8) | controller number
+    uint32_t designator;
+    int value;
+};
+
+/// Flat lookup table from automation designators (16 channels x 128
+/// controllers) to parameter values. Rebuilt from the automation_map
+/// whenever the mappings change, so that applying a CC doesn't need a map
+/// lookup or any parameter scaling in the process thread.
+struct automation_dispatch
+{
+    enum { slot_count = 16 * 128 };
+    struct target
+    {
+        int param_no;
+        /// parameter value for each CC value
+        float values[128];
+    };
+    /// targets[first[slot]] to targets[first[slot + 1] - 1] are mapped to slot
+    unsigned int first[slot_count + 1];
+    std::vector<target> targets;
+
+    automation_dispatch(const automation_map &amap, const plugin_metadata_iface *metadata);
+    /// Table slot for a designator, -1 if it can't come from a MIDI CC
+    static inline int slot(uint32_t designator)
+    {
+        if (designator >= 0x1000 || (designator & 0x80))
+            return -1;
+        return ((designator >> 8) << 7) | (designator & 127);
+    }
+};
+
+/// DSP load of a plugin instance - the time spent processing a cycle as a
+/// fraction of the cycle period. Measured by the process thread, and read
+/// by other threads without locking.
+struct dsp_load_meter
+{
+    /// histogram bins of 1% load each, the last one is for everything above
+    enum { hist_bins = 201 };
+    struct stats
+    {
+        float mean, p99, max;
+        /// number of cycles measured
+        uint32_t cycles;
+    };
+    struct accumulator
+    {
+        uint32_t hist[hist_bins];
+        double sum, max;
+        uint32_t cycles;
+        void reset() { memset(this, 0, sizeof(*this)); }
+        inline void add(double load) {
+            int bin = (int)(load * 100);
+            hist[bin < hist_bins ? bin : hist_bins - 1]++;
+            sum += load;
+            if (load > max)
+                max = load;
+            cycles++;
+        }
+        void get(stats &s) const;
+    };
+    /// the last second or so, and everything since the start
+    accumulator window, total;
+    uint32_t window_frames;
+    /// odd while last/overall are being updated
+    volatile uint32_t serial;
+    stats last, overall;
+
+    dsp_load_meter() { reset(); }
+    void reset();
+    /// Process thread: account for a cycle of nframes that took the given time
+    void add_cycle(double seconds, uint32_t nframes, uint32_t sample_rate);
+    /// Statistics of the last complete measurement window (about a second)
+    /// and of the whole run. Returns the serial number of the window.
+    uint32_t get(stats &last, stats &overall) const;
+    static inline double now() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec + ts.tv_nsec * 1e-9;
+    }
+};
+
 class jack_client {
 protected:
+    /// Master copy of the plugin chain, only used by non-realtime threads (with mutex held)
     std::vector<jack_host *> plugins;
     calf_utils::ptmutex mutex;
+    /// Immutable copy of the plugin chain used by the process callback,
+    /// replaced as a whole by publish_plugins()
+    std::vector<jack_host *> *volatile rt_plugins;
+    /// Incremented by the process callback on entry and on exit, so it's odd
+    /// while a cycle is running
+    volatile int rt_epoch;
+    /// Hand the current plugin chain over to the process callback, and
+    /// free the old one once the process callback doesn't use it anymore
+    void publish_plugins();
 
     /// Common port for MIDI parameter automation
     jack_port_t *automation_port;
+    /// Controller changes received on automation_port in the current cycle
+    std::vector<automation_event> automation_events;
+    unsigned int automation_event_count;
+    /// Fill automation_events from the automation port
+    void decode_automation(jack_nframes_t nframes);
 
 public:
     jack_client_t *client;
@@ -62,6 +166,7 @@ public:
     int sample_rate;
 
     jack_client();
+    ~jack_client();
     void add(jack_host *plugin);
     void del(jack_host *plugin);
     void open(const char *client_name, const char *jack_session_id);
@@ -76,15 +181,13 @@ public:
     void apply_plugin_order(const std::vector<int> &indices);
     void calculate_plugin_order(std::vector<int> &indices);
     const char **get_ports(const char *name_re, const char *type_re, unsigned long flags);
+    /// Wait until the process cycle running at the time of the call (if any)
+    /// is finished. After an atomic pointer swap, this guarantees that the
+    /// process callback doesn't use the old object anymore.
+    void wait_for_cycle();
     
     static int do_jack_process(jack_nframes_t nframes, void *p);
     static int do_jack_bufsize(jack_nframes_t numsamples, void *p);
-    template<class T>
-    void atomic_swap(T &v1, T &v2)
-    {
-        calf_utils::ptlock lock(mutex);
-        std::swap(v1, v2);
-    }
 };
 
 class jack_host: public plugin_ctl_iface {
@@ -104,9 +207,13 @@ public:
     float midi_meter;
     audio_module_iface *module;
     automation_map *cc_mappings;
+    /// Lookup table built from cc_mappings, used by the process thread
+    automation_dispatch *cc_dispatch;
     std::vector<int> write_serials;
     int last_modify_serial;
     uint32_t last_designator;
+    /// Time spent in process() - module processing, parameter changes and metering
+    dsp_load_meter load_meter;
     
 public:
     typedef int (*process_func)(jack_nframes_t nframes, void *p);
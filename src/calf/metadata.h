@@ -48,7 +48,7 @@ struct phaser_metadata: public plugin_metadata<phaser_metadata>
         param_on, param_level_in, param_level_out,
         STEREO_VU_METER_PARAMS, param_lfo,
         param_count };
-    enum { in_count = 2, out_count = 2, ins_optional = 0, outs_optional = 0, support_midi = false, require_midi = false, rt_capable = true, require_instance_access = false };
+    enum { in_count = 2, out_count = 2, ins_optional = 0, outs_optional = 0, support_midi = false, require_midi = false, rt_capable = true, require_instance_access = false, in_place_safe = true };
     PLUGIN_NAME_ID_LABEL("phaser", "phaser", "Phaser")
 };
 
@@ -98,7 +98,7 @@ struct reverb_metadata: public plugin_metadata<reverb_metadata>
            param_level_in, param_level_out,
            param_meter_outL, param_meter_outR, param_clip_inL, param_clip_inR, param_clip_outR,
            param_count };
-    enum { in_count = 2, out_count = 2, ins_optional = 0, outs_optional = 0, support_midi = false, require_midi = false, rt_capable = true, require_instance_access = false };
+    enum { in_count = 2, out_count = 2, ins_optional = 0, outs_optional = 0, support_midi = false, require_midi = false, rt_capable = true, require_instance_access = false, in_place_safe = true };
     PLUGIN_NAME_ID_LABEL("reverb", "reverb", "Reverb")
 };
 
@@ -111,7 +111,7 @@ struct vintage_delay_metadata: public plugin_metadata<vintage_delay_metadata>
             par_width, par_frag, par_pbeats, par_pfrag,
             PERIODICAL_PARAMS,
             param_count };
-    enum { in_count = 2, out_count = 2, ins_optional = 0, outs_optional = 0, rt_capable = true, support_midi = false, require_midi = false, require_instance_access = false };
+    enum { in_count = 2, out_count = 2, ins_optional = 0, outs_optional = 0, rt_capable = true, support_midi = false, require_midi = false, require_instance_access = false, in_place_safe = true };
     PLUGIN_NAME_ID_LABEL("vintagedelay", "vintagedelay", "Vintage Delay")
 };
 
@@ -155,7 +155,7 @@ struct rotary_speaker_metadata: public plugin_metadata<rotary_speaker_metadata>
 public:
     enum { par_speed, par_spacing, par_shift, par_moddepth, par_treblespeed, par_bassspeed, par_micdistance, par_reflection, par_am_depth, par_test, par_meter_l, par_meter_h,
         param_bypass, param_level_in, param_level_out,
-        STEREO_VU_METER_PARAMS,
+        STEREO_VU_METER_PARAMS, par_interp,
         param_count };
     enum { in_count = 2, out_count = 2, ins_optional = 0, outs_optional = 0, support_midi = true, require_midi = false, rt_capable = true, require_instance_access = false };
     PLUGIN_NAME_ID_LABEL("rotary_speaker", "rotaryspeaker", "Rotary Speaker")
@@ -561,7 +561,7 @@ struct equalizer30band_metadata: public plugin_metadata<equalizer30band_metadata
 /// Markus's X-Overs
 struct xover2_metadata: public plugin_metadata<xover2_metadata>
 {
-    enum { in_count = 2, out_count = 4, ins_optional = 0, outs_optional = 0, support_midi = false, require_midi = false, rt_capable = true, require_instance_access = false };
+    enum { in_count = 2, out_count = 4, ins_optional = 0, outs_optional = 0, support_midi = false, require_midi = false, rt_capable = true, require_instance_access = false, in_place_safe = true };
     enum { param_level, param_meter_0, param_meter_1, param_mode,
            param_freq0,
            param_level1, param_active1, param_phase1, param_delay1, param_meter_01, param_meter_11,
@@ -572,7 +572,7 @@ struct xover2_metadata: public plugin_metadata<xover2_metadata>
 };
 struct xover3_metadata: public plugin_metadata<xover3_metadata>
 {
-    enum { in_count = 2, out_count = 6, ins_optional = 0, outs_optional = 0, support_midi = false, require_midi = false, rt_capable = true, require_instance_access = false };
+    enum { in_count = 2, out_count = 6, ins_optional = 0, outs_optional = 0, support_midi = false, require_midi = false, rt_capable = true, require_instance_access = false, in_place_safe = true };
     enum { param_level, param_meter_0, param_meter_1, param_mode,
            param_freq0, param_freq1,
            param_level1, param_active1, param_phase1, param_delay1, param_meter_01, param_meter_11,
@@ -584,7 +584,7 @@ struct xover3_metadata: public plugin_metadata<xover3_metadata>
 };
 struct xover4_metadata: public plugin_metadata<xover4_metadata>
 {
-    enum { in_count = 2, out_count = 8, ins_optional = 0, outs_optional = 0, support_midi = false, require_midi = false, rt_capable = true, require_instance_access = false };
+    enum { in_count = 2, out_count = 8, ins_optional = 0, outs_optional = 0, support_midi = false, require_midi = false, rt_capable = true, require_instance_access = false, in_place_safe = true };
     enum { param_level, param_meter_0, param_meter_1, param_mode,
            param_freq0, param_freq1, param_freq2,
            param_level1, param_active1, param_phase1, param_delay1, param_meter_01, param_meter_11,
@@ -685,7 +685,7 @@ struct saturator_metadata: public plugin_metadata<saturator_metadata>
            STEREO_VU_METER_PARAMS,
            param_mix, param_drive, param_blend,
            param_lp_pre_freq, param_hp_pre_freq, param_lp_post_freq, param_hp_post_freq,
-           param_p_freq, param_p_level, param_p_q, param_pre, param_post, param_count };
+           param_p_freq, param_p_level, param_p_q, param_pre, param_post, param_quality, param_count };
     PLUGIN_NAME_ID_LABEL("saturator", "saturator", "Saturator")
 };
 /// Markus's Exciter - metadata
@@ -693,7 +693,7 @@ struct exciter_metadata: public plugin_metadata<exciter_metadata>
 {
     enum { in_count = 2, out_count = 2, ins_optional = 1, outs_optional = 1, support_midi = false, require_midi = false, rt_capable = true, require_instance_access = false };
     enum { param_bypass, param_level_in, param_level_out, param_amount, MONO_VU_METER_PARAMS, param_drive, param_blend, param_meter_drive,
-           param_freq, param_listen, param_ceil_active, param_ceil, param_count };
+           param_freq, param_listen, param_ceil_active, param_ceil, param_quality, param_count };
     PLUGIN_NAME_ID_LABEL("exciter", "exciter", "Exciter")
 };
 /// Markus's Bass Enhancer - metadata
@@ -701,7 +701,7 @@ struct bassenhancer_metadata: public plugin_metadata<bassenhancer_metadata>
 {
     enum { in_count = 2, out_count = 2, ins_optional = 1, outs_optional = 1, support_midi = false, require_midi = false, rt_capable = true, require_instance_access = false };
     enum { param_bypass, param_level_in, param_level_out, param_amount, MONO_VU_METER_PARAMS, param_drive, param_blend, param_meter_drive,
-           param_freq, param_listen, param_floor_active, param_floor, param_count };
+           param_freq, param_listen, param_floor_active, param_floor, param_quality, param_count };
     PLUGIN_NAME_ID_LABEL("bassenhancer", "bassenhancer", "Bass Enhancer")
 };
 /// Markus's and Chrischi's Crusher Module - metadata
@@ -752,7 +752,7 @@ struct multibandenhancer_metadata: public plugin_metadata<multibandenhancer_meta
            param_drive0, param_drive1, param_drive2, param_drive3,
            param_blend0, param_blend1, param_blend2, param_blend3,
            param_solo0, param_solo1, param_solo2, param_solo3,
-           param_count };
+           param_quality, param_count };
     PLUGIN_NAME_ID_LABEL("multibandenhancer", "multibandenhancer", "Multiband Enhancer")
 };
 /// Markus's  multispread - metadata
@@ -770,7 +770,7 @@ struct multispread_metadata: public plugin_metadata<multispread_metadata>
 /// Markus's and Chrischi's Analyzer
 struct analyzer_metadata: public plugin_metadata<analyzer_metadata>
 {
-    enum { in_count = 2, out_count = 2, ins_optional = 1, outs_optional = 1, support_midi = false, require_midi = false, rt_capable = true, require_instance_access = true };
+    enum { in_count = 2, out_count = 2, ins_optional = 1, outs_optional = 1, support_midi = false, require_midi = false, rt_capable = true, require_instance_access = true, in_place_safe = true };
     enum { param_meter_L, param_meter_R, param_clip_L, param_clip_R,
            param_analyzer_level, param_analyzer_mode,
            param_analyzer_scale, param_analyzer_post,
@@ -856,6 +856,7 @@ struct organ_enums
         par_treblefreq,
         par_treblegain,
         par_midi,
+        par_steal,
         param_count
     };
     enum organ_waveform {
@@ -1004,6 +1005,7 @@ struct wavetable_metadata: public plugin_metadata<wavetable_metadata>
         par_lfo1rate,
         par_lfo2rate,
         par_midi,
+        par_steal,
         param_count };
     enum { in_count = 0, out_count = 2, ins_optional = 0, outs_optional = 0, support_midi = true, require_midi = true, rt_capable = true, require_instance_access = false };
     enum { mod_matrix_slots = 10 };
@@ -68,29 +68,67 @@ namespace calf_plugins {
 class mod_matrix_impl
 {
 protected:
+    /// Single instruction of the compiled modulation matrix, with the mapping
+    /// polynomial already multiplied by the modulation amount
+    struct compiled_row
+    {
+        int src1, src2, dest, mapping;
+        float c0, c1, c2;
+    };
+    /// Compiled form of the matrix - active rows only, sorted by destination and mapping mode
+    struct compiled_program
+    {
+        compiled_row *rows;
+        /// Number of valid entries in rows
+        unsigned int count;
+    };
     dsp::modulation_entry *matrix;
     mod_matrix_metadata *metadata;
     unsigned int matrix_rows;
+    /// Storage for the three copies of the compiled program, matrix_rows entries each
+    compiled_row *program_rows;
+    /// The matrix is compiled in configure() (GUI thread) and evaluated in the audio thread
+    graph_snapshot<compiled_program> program;
     /// Polynomials for different scaling modes (1, x, x^2)
     static const float scaling_coeffs[calf_plugins::mod_matrix_metadata::map_type_count][3];
 
+    /// Rebuild the compiled program from the matrix rows and publish it to the audio thread,
+    /// must be called after any change to matrix
+    void compile_matrix();
 public:
     mod_matrix_impl(dsp::modulation_entry *_matrix, calf_plugins::mod_matrix_metadata *_metadata);
 
     /// Process modulation matrix, calculate outputs from inputs
     inline void calculate_modmatrix(float *moddest, int moddest_count, float *modsrc)
     {
+        const compiled_program &prog = program.get_read();
         for (int i = 0; i < moddest_count; i++)
             moddest[i] = 0;
-        for (unsigned int i = 0; i < matrix_rows; ++i)
+        for (unsigned int i = 0; i < prog.count; ++i)
+        {
+            const compiled_row &row = prog.rows[i];
+            float value = modsrc[row.src1];
+            moddest[row.dest] += (row.c0 + (row.c1 + row.c2 * value) * value) * modsrc[row.src2];
+        }
+    }
+    /// Process modulation matrix for several voices at once. Both arrays are
+    /// stored source-major, so that value of source s for voice v is modsrc[s * stride + v]
+    /// (and likewise for moddest), which lets the inner loop run across voices.
+    inline void calculate_modmatrix_multi(float *moddest, int moddest_count, const float *modsrc, int stride, int nvoices)
+    {
+        for (int i = 0; i < moddest_count; i++)
+            for (int v = 0; v < nvoices; v++)
+                moddest[i * stride + v] = 0;
+        const compiled_program &prog = program.get_read();
+        for (unsigned int i = 0; i < prog.count; ++i)
         {
-            dsp::modulation_entry &slot = matrix[i];
-            if (slot.dest) {
-                float value = modsrc[slot.src1];
-                const float *c = scaling_coeffs[slot.mapping];
-                value = c[0] + c[1] * value + c[2] * value * value;
-                moddest[slot.dest] += value * modsrc[slot.src2] * slot.amount;
-            }
+            const compiled_row &row = prog.rows[i];
+            const float *__restrict s1 = modsrc + row.src1 * stride;
+            const float *__restrict s2 = modsrc + row.src2 * stride;
+            float *__restrict d = moddest + row.dest * stride;
+            float c0 = row.c0, c1 = row.c1, c2 = row.c2;
+            for (int v = 0; v < nvoices; v++)
+                d[v] += (c0 + (c1 + c2 * s1[v]) * s1[v]) * s2[v];
         }
     }
     void send_configures(send_configure_iface *);
@@ -98,6 +136,7 @@ public:
     
     virtual const dsp::modulation_entry *get_default_mod_matrix_value(int row) const
     { return NULL; }
+    virtual ~mod_matrix_impl();
     
 private:
     std::string get_cell(int row, int column) const;
@@ -149,6 +149,7 @@ public:
     void activate();
     void deactivate();
     void params_changed();
+    int get_tail_length() const;
     void set_sample_rate(uint32_t sr);
     uint32_t process(uint32_t offset, uint32_t numsamples, uint32_t inputs_mask, uint32_t outputs_mask);
     bool get_graph(int index, int subindex, int phase, float *data, int points, cairo_iface *context, int *mode) const;
@@ -193,7 +194,7 @@ public:
     sidechaincompressor_audio_module();
     void activate();
     void deactivate();
-    void params_changed();
+    void control_tick();
     cfloat h_z(const cfloat &z) const;
     float freq_gain(int index, double freq) const;
     void set_sample_rate(uint32_t sr);
@@ -212,6 +213,7 @@ class multibandcompressor_audio_module: public audio_module<multibandcompressor_
 private:
     typedef multibandcompressor_audio_module AM;
     static const int strips = 4;
+    enum { SMOOTH_LEVEL_IN, SMOOTH_LEVEL_OUT, SMOOTH_COUNT };
     bool solo[strips];
     float xin[2];
     bool no_solo;
@@ -221,6 +223,7 @@ private:
     int mode, page, bypass_;
     mutable int redraw;
     vumeters meters;
+    smoothed_params smoothed;
 public:
     uint32_t srate;
     bool is_active;
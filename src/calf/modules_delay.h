@@ -25,6 +25,7 @@
 #include <assert.h>
 #include <limits.h>
 #include "biquad.h"
+#include "buffer.h"
 #include "bypass.h"
 #include "inertia.h"
 #include "audio_fx.h"
@@ -54,6 +55,7 @@ public:
     int predelay_amt;
     
     void params_changed();
+    int get_tail_length() const;
     uint32_t process(uint32_t offset, uint32_t numsamples, uint32_t inputs_mask, uint32_t outputs_mask);
     void activate();
     void set_sample_rate(uint32_t sr);
@@ -67,13 +69,16 @@ public:
 class vintage_delay_audio_module: public audio_module<vintage_delay_metadata>, public frequency_response_line_graph
 {
 public:    
-    // 1MB of delay memory per channel... uh, RAM is cheap
-    enum { MAX_DELAY = 524288, ADDR_MASK = MAX_DELAY - 1 };
+    /// smallest ring size
+    enum { MIN_DELAY = 65536 };
     enum { MIXMODE_STEREO, MIXMODE_PINGPONG, MIXMODE_LR, MIXMODE_RL }; 
     enum { FRAG_PERIODIC, FRAG_PATTERN };
-    float buffers[2][MAX_DELAY];
+    enum { SMOOTH_LEVEL_IN, SMOOTH_LEVEL_OUT, SMOOTH_COUNT };
+    /// sized for the longest delay at the current sample rate
+    dsp::mapped_buffer<float> buffers[2];
+    int buf_size, buf_mask; // buf_size is guaranteed to be power of 2
     int bufptr, deltime_l, deltime_r, mixmode, medium, old_medium;
-    /// number of table entries written (value is only important when it is less than MAX_DELAY, which means that the buffer hasn't been totally filled yet)
+    /// number of table entries written (value is only important when it is less than buf_size, which means that the buffer hasn't been totally filled yet)
     int age;
     
     dsp::gain_smoothing amt_left, amt_right, fb_left, fb_right, dry, chmix;
@@ -84,7 +89,11 @@ public:
     
     vintage_delay_audio_module();
     
-    void params_changed();
+    /// see get_tail_length, updated in control_tick
+    int tail_length;
+    
+    void control_tick();
+    int get_tail_length() const { return tail_length; }
     void activate();
     void deactivate();
     void set_sample_rate(uint32_t sr);
@@ -96,6 +105,7 @@ public:
     long _tap_last;
     
     vumeters meters;
+    smoothed_params smoothed;
 };
 
 /**********************************************************************
@@ -126,6 +136,7 @@ public:
     virtual ~comp_delay_audio_module();
 
     void params_changed();
+    int get_tail_length() const { return delay + vumeters::settle_time(srate); }
     void activate();
     void deactivate();
     void set_sample_rate(uint32_t sr);
@@ -168,8 +179,10 @@ public:
 class reverse_delay_audio_module: public audio_module<reverse_delay_metadata>
 {
 public:
-    enum { MAX_DELAY = 6144000, ADDR_MASK = MAX_DELAY - 1 };
-    float buffers[2][MAX_DELAY];
+    /// sized for the longest delay at the current sample rate
+    dsp::mapped_buffer<float> buffers[2];
+    /// number of entries that may have been written to since the last clear
+    int buf_used;
     int counters[2];
     dsp::overlap_window ow[2];
     int deltime_l, deltime_r;
@@ -24,38 +24,118 @@
 #include <calf/metadata.h>
 
 #if ENABLE_EXPERIMENTAL
+#include <calf/giface.h>
+#include <calf/utils.h>
 #include <fluidsynth.h>
+#include <limits.h>
+#include <pthread.h>
+#include <semaphore.h>
 #endif
 
 namespace calf_plugins {
 
 #if ENABLE_EXPERIMENTAL
     
+/// A soundfont shared between all fluidsynth module instances in the process
+struct shared_soundfont
+{
+    /// Soundfont filename
+    std::string path;
+    /// Modification time of the file when it was loaded
+    time_t mtime;
+    /// Number of module instances (and pending loads) using this soundfont
+    int refcount;
+    /// Settings for the holder synth
+    fluid_settings_t *settings;
+    /// Synth object that keeps the soundfont (and FluidSynth's sample cache entry) loaded
+    fluid_synth_t *holder;
+    /// Soundfont name (as received from Fluidsynth)
+    std::string name;
+    /// TAB-separated preset list (preset+128*bank TAB preset name LF)
+    std::string preset_list;
+    /// Map of preset+128*bank to preset name
+    std::map<uint32_t, std::string> preset_names;
+    /// First preset+128*bank in the soundfont, or -1 if none
+    int first_preset;
+};
+
+/// Process-wide, reference counted cache of loaded soundfonts, keyed by path and modification time
+class soundfont_cache
+{
+public:
+    /// Return a reference to a loaded soundfont, loading it if necessary; NULL if it cannot be loaded
+    static shared_soundfont *acquire(const std::string &path);
+    /// Return another reference to the soundfont sf currently points to (NULL if none), read
+    /// under the cache lock, so that it cannot be released by another thread in the meantime
+    static shared_soundfont *acquire_ref(shared_soundfont *const &sf);
+    /// Release a reference obtained from acquire or acquire_ref
+    static void release(shared_soundfont *sf);
+};
+
 /// Tiny wrapper for fluidsynth
 class fluidsynth_audio_module: public audio_module<fluidsynth_metadata>
 {
 protected:
+    /// Ownership of the pending_ variables, which pass synths between the loader thread and process()
+    enum load_state_type {
+        load_idle, ///< owned by the loader thread, empty unless it's loading
+        load_ready, ///< new synth is ready, waiting for process() to pick it up
+        load_swapped, ///< swapped in, the old synth is waiting for the loader thread to delete it
+    };
     /// Current sample rate
     uint32_t srate;
     /// FluidSynth Settings object
     fluid_settings_t *settings;
     /// FluidSynth Synth object
     fluid_synth_t *synth;
-    /// Soundfont filename
-    std::string soundfont;
-    /// Soundfont filename (as received from Fluidsynth)
-    std::string soundfont_name;
-    /// TAB-separated preset list (preset+128*bank TAB preset name LF)
-    std::string soundfont_preset_list;
+    /// Soundfont filename requested by configure (empty = blank synth), preallocated
+    /// because configure may be called from the audio thread
+    char soundfont[PATH_MAX];
+    /// Soundfont load request, passed from configure to the loader thread
+    struct load_request_type {
+        /// Soundfont filename, empty = blank synth
+        char path[PATH_MAX];
+        /// True if the filename didn't fit into path (the load fails)
+        bool too_long;
+        /// Number of the request, see request_serial
+        int serial;
+    };
+    calf_plugins::graph_snapshot<load_request_type> load_requests;
+    /// Number of the last request made by configure (0 = none yet)
+    int request_serial;
+    /// Number of the last request picked up by the loader thread
+    int picked_serial;
+    /// Number of the last request that has either failed or had its synth swapped in by process()
+    volatile int done_serial;
+    /// Soundfont used by the current synth (NULL if none)
+    shared_soundfont *sf;
     /// FluidSynth assigned SoundFont ID
     int sfid;
-    /// Map of preset+128*bank to preset name
-    std::map<uint32_t, std::string> sf_preset_names;
+    /// Background loader state (one of load_state_type)
+    volatile int load_state;
+    /// Background loader thread, it creates new synths and deletes the replaced ones
+    pthread_t load_thread;
+    /// True if load_thread is running
+    bool load_thread_started;
+    /// Posted to wake the loader thread up (new request, synth swapped in, shutdown)
+    sem_t load_sem;
+    /// Tells the loader thread to exit
+    volatile bool load_quit;
+    /// Progress of the loader thread for send_status_updates to report (-1 = nothing new), guarded by load_mutex
+    int load_progress;
+    /// Message to go with load_progress, guarded by load_mutex
+    std::string load_message;
+    calf_utils::ptmutex load_mutex;
+    /// Synth, soundfont and soundfont ID created by the loader thread, and the number of its request
+    fluid_synth_t *pending_synth;
+    shared_soundfont *pending_sf;
+    int pending_sfid;
+    int pending_serial;
     /// Last selected preset+128*bank in each channel
     uint32_t last_selected_presets[16];
     /// Serial number of status data
     volatile int status_serial;
-    /// Preset number to set on next process() call
+    /// Preset number to set on next process() call (held back while a soundfont is being loaded)
     volatile int set_presets[16];
     volatile bool soundfont_loaded;
 
@@ -63,8 +143,17 @@ protected:
     void update_preset_num(int channel);
     /// Send a bank/program change sequence for a specific channel/preset combo
     void select_preset_in_channel(int ch, int new_preset);
-    /// Create a fluidsynth object and load the current soundfont
-    fluid_synth_t *create_synth(int &new_sfid);
+    /// Create a fluidsynth object and load the given soundfont (if any)
+    fluid_synth_t *create_synth(shared_soundfont *new_sf, int &new_sfid);
+    /// Wake the loader thread up to handle the latest request, never waits (configure may be called from the audio thread)
+    void request_load();
+    /// Pass the loader's progress on to send_status_updates
+    void set_load_progress(int progress, const std::string &message);
+    /// Delete the synth replaced by process() and handle the latest load request, if possible
+    /// (loader thread, or post_instantiate/send_status_updates if there is none)
+    void load_step();
+    /// Loader thread body
+    static void *loader_thread(void *arg);
 public:
     /// Constructor to initialize handles to NULL
     fluidsynth_audio_module();
@@ -29,7 +29,6 @@
 #include "giface.h"
 #include "metadata.h"
 #include "plugin_tools.h"
-#include <fluidsynth.h>
 
 
 namespace calf_plugins {
@@ -132,9 +131,9 @@ class vinyl_audio_module:
     vumeters meters;
     dsp::simple_lfo lfo;
     dsp::biquad_d2 filters[2][_filters];
-    fluid_synth_t *synth;
-    fluid_settings_t* settings;
-    float last_gain[_synths];
+    /// Noise layer samples, shared with the other instances (see sf2_sample_cache)
+    const dsp::sf2_stereo_sample *samples[_synths];
+    dsp::sample_layer layers[_synths];
     
     uint32_t dbufsize, dbufpos;
     float *dbuf;
@@ -70,6 +70,25 @@ private:
     dsp::bypass bypass;
     int keep_gliding;
     mutable int last_peak;
+    /// Copy of the coefficients and settings the graphs need, published by params_changed()
+    struct graph_state {
+        dsp::biquad_coeffs hp, lp, ls, hs, p[PeakBands];
+        /// number of times HP/LP are applied (0 if inactive)
+        int hp_stages, lp_stages;
+        bool ls_active, hs_active, p_active[PeakBands];
+        bool individuals, analyzer_active;
+        int analyzer_mode;
+        float zoom;
+        uint32_t srate;
+        graph_state() : hp_stages(0), lp_stages(0), ls_active(false), hs_active(false), individuals(false), analyzer_active(false), analyzer_mode(0), zoom(1), srate(44100) {
+            for (int i = 0; i < PeakBands; i++)
+                p_active[i] = false;
+        }
+    };
+    graph_snapshot<graph_state> graph;
+    void publish_graph();
+    /// Cached curves: overall response, then each band (peaks, low shelf, high shelf, HP, LP)
+    mutable biquad_response_cache response_cache[PeakBands + 5];
     inline void process_hplp(float &left, float &right);
 public:
     typedef std::complex<double> cfloat;
@@ -417,10 +436,14 @@ public:
     uint32_t srate;
     bool is_active;
     static const int maxorder = 8;
+    /// indices into smoothed: global levels first, then smooth_band_count values per band
+    enum { smooth_carrier_in, smooth_mod_in, smooth_carrier, smooth_mod, smooth_proc, smooth_out, smooth_bands };
+    enum { smooth_volume, smooth_pan, smooth_noise, smooth_bandmod, smooth_band_count };
     dsp::biquad_d2 detector[2][maxorder][32], modulator[2][maxorder][32];
     dsp::bypass bypass;
     double env_mods[2][32];
     vumeters meters;
+    smoothed_params smoothed;
     analyzer _analyzer;
     double attack, release, fcoeff, log2_;
     vocoder_audio_module();
@@ -435,6 +458,15 @@ public:
         int meter[] = {param_carrier_inL, param_carrier_inR,  param_mod_inL, param_mod_inR, param_outL, param_outR};
         int clip[] = {param_carrier_clip_inL, param_carrier_clip_inR, param_mod_clip_inL, param_mod_clip_inR, param_clip_outL, param_clip_outR};
         meters.init(params, meter, clip, 6, sr);
+        int smooth[smooth_bands + 32 * smooth_band_count] = {param_carrier_in, param_mod_in, param_carrier, param_mod, param_proc, param_out};
+        for (int i = 0; i < 32; i++) {
+            int *band = smooth + smooth_bands + i * smooth_band_count;
+            band[smooth_volume]  = param_volume0 + i * band_params;
+            band[smooth_pan]     = param_pan0 + i * band_params;
+            band[smooth_noise]   = param_noise0 + i * band_params;
+            band[smooth_bandmod] = param_mod0 + i * band_params;
+        }
+        smoothed.init(params, smooth, smooth_bands + 32 * smooth_band_count, sr);
     }
     virtual bool get_graph(int index, int subindex, int phase, float *data, int points, cairo_iface *context, int *mode) const;
     virtual bool get_layers(int index, int generation, unsigned int &layers) const;
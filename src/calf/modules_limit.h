@@ -56,6 +56,7 @@ public:
     void activate();
     void deactivate();
     void params_changed();
+    int get_tail_length() const;
     void set_srates();
     uint32_t process(uint32_t offset, uint32_t numsamples, uint32_t inputs_mask, uint32_t outputs_mask);
     void set_sample_rate(uint32_t sr);
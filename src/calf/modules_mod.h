@@ -79,12 +79,9 @@ public:
 class phaser_audio_module: public audio_module<phaser_metadata>, public frequency_response_line_graph
 {
 public:
-    enum { MaxStages = 12 };
     uint32_t srate;
     bool clear_reset;
-    float last_r_phase;
-    dsp::simple_phaser left, right;
-    float x1vals[2][MaxStages], y1vals[2][MaxStages];
+    dsp::stereo_phaser phaser;
     bool is_active;
     dsp::bypass bypass;
     vumeters meters;
@@ -96,12 +93,13 @@ public:
     void set_sample_rate(uint32_t sr);
     void deactivate();
     uint32_t process(uint32_t offset, uint32_t nsamples, uint32_t inputs_mask, uint32_t outputs_mask) {
-        left.process(outs[0] + offset, ins[0] + offset, nsamples, *params[param_on] > 0.5, *params[param_level_in], *params[param_level_out]);
-        right.process(outs[1] + offset, ins[1] + offset, nsamples, *params[param_on] > 0.5, *params[param_level_in], *params[param_level_out]);
-        for (uint32_t i = offset; i < offset + nsamples; i++) {
-            float values[] = {ins[0][i] * *params[param_level_in], ins[1][i] * *params[param_level_in], outs[0][i], outs[1][i]};
-            meters.process(values);
-        }
+        float level_in = *params[param_level_in];
+        const float *bufs[] = {ins[0], ins[1], outs[0], outs[1]};
+        float gains[] = {level_in, level_in, 1.f, 1.f};
+        // input meters first, the host may process in place
+        meters.process(bufs, gains, offset, nsamples, 0, 2);
+        phaser.process(outs[0] + offset, outs[1] + offset, ins[0] + offset, ins[1] + offset, nsamples, *params[param_on] > 0.5, level_in, *params[param_level_out]);
+        meters.process(bufs, gains, offset, nsamples, 2, 2);
         meters.fall(nsamples);
         return outputs_mask; // XXXKF allow some delay after input going blank
     }
@@ -118,11 +116,15 @@ public:
 class rotary_speaker_audio_module: public audio_module<rotary_speaker_metadata>
 {
 public:
+    /// Rotor positions are calculated every SubBlock samples and interpolated in between
+    enum { SubBlock = 32 };
     /// Current phases and phase deltas for bass and treble rotors
     uint32_t phase_l, dphase_l, phase_h, dphase_h;
     dsp::simple_delay<1024, float> delay;
-    dsp::biquad_d2 crossover1l, crossover1r, crossover2l, crossover2r, damper1l, damper1r;
-    dsp::simple_delay<8, float> phaseshift;
+    /// Output filters - treble left/right (lanes 0, 1) and bass left/right (lanes 2, 3)
+    dsp::biquad_d2_lanes<4> crossover;
+    /// Treble horn resonance, left/right
+    dsp::biquad_d2_lanes<2> damper;
     uint32_t srate;
     dsp::bypass bypass;
     vumeters meters;
@@ -159,6 +161,9 @@ public:
     void update_speed_manual(float delta);
     /// Increase or decrease aspeed towards raspeed, with required negative and positive rate
     bool incr_towards(float &aspeed, float raspeed, float delta_decc, float delta_acc);
+    /// Run the rotor simulation, Cubic selects the delay tap interpolation
+    template<bool Cubic>
+    void process_rotors(uint32_t offset, uint32_t nsamples);
     uint32_t process(uint32_t offset, uint32_t nsamples, uint32_t inputs_mask, uint32_t outputs_mask);
     virtual void control_change(int channel, int ctl, int val);
 };
@@ -92,9 +92,25 @@ public:
         // apply the voice offset/depth (rescale from -65535..65535 to appropriate voice's "band")
         return -65535 + voice * voice_offset + ((voice_depth >> (30-13)) * (65536 + intval) >> 13);
     }
+    /// Get LFO values for given voice for count consecutive samples, starting at the current phase (same values as get_value)
+    inline void get_values(uint32_t voice, int *values, int count, bool stepping) const {
+        chorus_phase voice_phase = phase + vphase * (int)voice;
+        int offset = -65535 + voice * voice_offset;
+        int depth = voice_depth >> (30-13);
+        for (int i = 0; i < count; i++) {
+            unsigned int ipart = voice_phase.ipart();
+            int intval = voice_phase.lerp_by_fract_int<int, 14, int>(sine.data[ipart], sine.data[ipart+1]);
+            values[i] = offset + (depth * (65536 + intval) >> 13);
+            if (stepping)
+                voice_phase += dphase;
+        }
+    }
     inline void step() {
         phase += dphase;
     }
+    inline void step(int count) {
+        phase += dphase * count;
+    }
     inline T get_scale() const {
         return scale;
     }
@@ -139,6 +155,16 @@ public:
         set_min_delay(get_min_delay());
         set_mod_depth(get_mod_depth());
     }
+    enum { BlockSize = 64 };
+    /**
+     * Process in blocks of up to BlockSize samples: all input samples of a block
+     * are written to the delay line first, then each voice generates its LFO
+     * positions for the whole block and accumulates its interpolated taps into
+     * a shared output block. The inner loops are over samples, with no
+     * dependencies between iterations, so the compiler can vectorise the delay
+     * reads. Output is identical to per-sample processing, as the shortest tap
+     * is always at least 2 samples behind the write position.
+     */
     template<class OutIter, class InIter>
     void process(OutIter buf_out, InIter buf_in, int nsamples, bool active, float level_in = 1., float level_out = 1.) {
         int mds = min_delay_samples + mod_depth_samples * 1024 + 2*65536;
@@ -150,32 +176,44 @@ public:
         // NB: calculation of mod_depth_samples (and multiply-by-32) is in chorus_base::set_mod_depth
         mdepth = mdepth >> 2;
         T scale = lfo.get_scale();
-        for (int i=0; i<nsamples; i++) {
-            if (lfo_active)
-                phase += dphase;
-            float in = *buf_in++ * level_in;
-            
-            delay.put(in);
-            unsigned int nvoices = lfo.get_voices();
-            T out = 0.f;
+        unsigned int nvoices = lfo.get_voices();
+        T in[BlockSize], out[BlockSize];
+        int lfo_output[BlockSize];
+        for (int p = 0; p < nsamples; p += BlockSize) {
+            int len = std::min<int>(BlockSize, nsamples - p);
+            // position just after the first sample of the block is written
+            int pos0 = delay.pos + 1;
+            for (int i = 0; i < len; i++) {
+                in[i] = *buf_in++ * level_in;
+                delay.put(in[i]);
+                out[i] = 0.f;
+            }
             // add up values from all voices, each voice tell its LFO phase and the buffer value is picked at that location
+            const T *data = &delay.data[0];
             for (unsigned int v = 0; v < nvoices; v++)
             {
-                int lfo_output = lfo.get_value(v);
-                // 3 = log2(32 >> 2) + 1 because the LFO value is in range of [-65535, 65535] (17 bits)
-                int dv = mds + (mdepth * lfo_output >> (3 + 1));
-                int ifv = dv >> 16;
-                T fd; // signal from delay's output
-                delay.get_interp(fd, ifv, (dv & 0xFFFF)*(1.0/65536.0));
-                out += fd;
+                lfo.get_values(v, lfo_output, len, lfo_active);
+                for (int i = 0; i < len; i++) {
+                    // 3 = log2(32 >> 2) + 1 because the LFO value is in range of [-65535, 65535] (17 bits)
+                    int dv = mds + (mdepth * lfo_output[i] >> (3 + 1));
+                    int ppos = (pos0 + i - (dv >> 16)) & (MaxDelay - 1);
+                    int pppos = (ppos - 1) & (MaxDelay - 1);
+                    float udelay = (dv & 0xFFFF)*(1.0/65536.0);
+                    out[i] += data[ppos] + (data[pppos] - data[ppos]) * udelay;
+                }
             }
             // apply the post filter
-            out = post.process(out);
-            T sdry = in * gs_dry.get();
-            T swet = out * gs_wet.get() * scale;
-            *buf_out++ = (sdry + (active ? swet : 0)) * level_out;
-            if (lfo_active)
-                lfo.step();
+            for (int i = 0; i < len; i++)
+                out[i] = post.process(out[i]);
+            for (int i = 0; i < len; i++) {
+                T sdry = in[i] * gs_dry.get();
+                T swet = out[i] * gs_wet.get() * scale;
+                *buf_out++ = (sdry + (active ? swet : 0)) * level_out;
+            }
+            if (lfo_active) {
+                phase += dphase * len;
+                lfo.step(len);
+            }
         }
         post.sanitize();
     }
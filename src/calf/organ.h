@@ -99,6 +99,7 @@ struct organ_parameters {
     float treble_gain;
     
     float dummy_mapcurve;
+    float steal_policy;
     
     //////////////////////////////////////////////////////////////////////////
     // these parameters are calculated
@@ -234,7 +235,7 @@ protected:
 public:
     organ_voice()
     : organ_voice_base(NULL, sample_rate, perc_released)
-    , expression(dsp::linear_ramp(16))
+    , expression(dsp::linear_ramp(16 * BlockSize))
     , inertia_pitchbend(dsp::exponential_ramp(1))
     {
         inertia_pitchbend.set_now(1);
@@ -244,8 +245,9 @@ public:
     void note_on(int note, int vel);
     void note_off(int /* vel */);
     virtual float get_priority() { return stolen ? 20000 : (perc_released ? 1 : (sostenuto ? 200 : 100)); }
+    virtual float get_level();
     virtual void steal();
-    void render_block(int current_snapshot);
+    void render_block(int current_snapshot, int len);
     
     virtual int get_current_note() {
         return note;
@@ -293,10 +295,11 @@ struct drawbar_organ: public dsp::basic_synth, public calf_plugins::organ_enums
      drawbar_organ(organ_parameters *_parameters)
     : parameters(_parameters)
     , percussion(_parameters) {
-        init_voices(36);
+        init_voices<block_voice<organ_voice> >(36);
+        for (voice_array::iterator i = allocated_voices.begin(); i != allocated_voices.end(); ++i)
+            static_cast<organ_voice *>(*i)->parameters = parameters;
     }
     void render_separate(float *output[], int nsamples);
-    dsp::voice *alloc_voice();
     virtual void percussion_note_on(int note, int vel);
     virtual void params_changed() = 0;
     virtual void setup(int sr);
@@ -66,6 +66,43 @@ public:
             }
         }
     }
+    /// Update all meters from a block of samples - buffers[i] + offset (NULL for silence)
+    /// multiplied by gains[i] (or 1 if gains is NULL) - and write the parameters once.
+    /// Only meters first..first+count-1 are updated if count is given, eg. to meter the
+    /// inputs before the outputs overwrite them in in-place processing.
+    void process(const float *const *buffers, const float *gains, uint32_t offset, uint32_t numsamples, size_t first = 0, size_t count = (size_t)-1) {
+        for (size_t i = first; i < meters.size() && i - first < count; ++i) {
+            meter_data &md = meters[i];
+            float *level = md.level_idx != -1 ? params[(int)abs(md.level_idx)] : NULL;
+            float *clip = md.clip_idx != -1 ? params[(int)abs(md.clip_idx)] : NULL;
+            if (!level && !clip)
+                continue;
+            md.meter.process_block(buffers[i] ? buffers[i] + offset : NULL, numsamples, gains ? gains[i] : 1.f);
+            write(md, level, clip);
+        }
+    }
+    /// Update all meters as if each values[i] was passed to process() numsamples times (eg. in bypass mode)
+    void process_constant(const float *values, uint32_t numsamples) {
+        for (size_t i = 0; i < meters.size(); ++i) {
+            meter_data &md = meters[i];
+            float *level = md.level_idx != -1 ? params[(int)abs(md.level_idx)] : NULL;
+            float *clip = md.clip_idx != -1 ? params[(int)abs(md.clip_idx)] : NULL;
+            if (!level && !clip)
+                continue;
+            md.meter.process_constant(values[i], numsamples);
+            write(md, level, clip);
+        }
+    }
+    static inline void write(const meter_data &md, float *level, float *clip) {
+        if (level)
+            *level = md.meter.level;
+        if (clip)
+            *clip = md.meter.clip > 0 ? 1.f : 0.f;
+    }
+    /// Samples it takes the meters to fall from full scale to the bottom of the scale (20 dB/s)
+    static uint32_t settle_time(uint32_t srate) {
+        return srate * 4;
+    }
     void fall(unsigned int numsamples) {
         for (size_t i = 0; i < meters.size(); ++i)
             if (meters[i].level_idx != -1)
@@ -73,6 +110,109 @@ public:
     }
 };
 
+/// Block-wise smoothing for a set of parameters. update() reads every port
+/// once per process() call; a changed value starts a linear ramp which is
+/// rendered into a contiguous buffer, so that sample loops read registers
+/// or ramp arrays instead of dereferencing *params[...] per sample.
+class smoothed_params
+{
+public:
+    struct smoothed_data
+    {
+        int param_no;
+        /// value after the last sample of the current block
+        float value;
+        /// value the ramp is heading to
+        float target;
+        float delta;
+        /// samples left until target is reached
+        uint32_t left;
+        /// true if get_ramp() is valid for the current block
+        bool ramping;
+    };
+
+    std::vector<smoothed_data> data;
+    std::vector<float> ramps;
+    float *const *params;
+    uint32_t ramp_len;
+    bool initialized;
+
+    smoothed_params() {
+        params = NULL;
+        ramp_len = 1;
+        initialized = false;
+    }
+    /// Smooth params[prms[i]] for i in 0..length-1, index i is later used to access the values
+    void init(float *const *prms, const int *param_nos, int length, uint32_t srate, float ramp_ms = 10.f) {
+        data.resize(length);
+        ramps.resize(length * MAX_SAMPLE_RUN);
+        for (int i = 0; i < length; i++)
+            data[i].param_no = param_nos[i];
+        params = prms;
+        set_sample_rate(srate, ramp_ms);
+        initialized = false;
+    }
+    void set_sample_rate(uint32_t srate, float ramp_ms = 10.f) {
+        ramp_len = std::max<uint32_t>(1, (uint32_t)(srate * ramp_ms * 0.001f));
+    }
+    /// Jump to the current parameter values (eg. on activation)
+    void reset() {
+        for (size_t i = 0; i < data.size(); ++i) {
+            smoothed_data &sd = data[i];
+            sd.value = sd.target = params[sd.param_no] ? *params[sd.param_no] : 0.f;
+            sd.delta = 0.f;
+            sd.left = 0;
+            sd.ramping = false;
+        }
+        initialized = true;
+    }
+    /// Read the ports and prepare the values for the next numsamples (<= MAX_SAMPLE_RUN) samples
+    void update(uint32_t numsamples) {
+        if (!initialized)
+            reset();
+        for (size_t i = 0; i < data.size(); ++i) {
+            smoothed_data &sd = data[i];
+            float target = params[sd.param_no] ? *params[sd.param_no] : sd.target;
+            if (target != sd.target) {
+                sd.target = target;
+                sd.delta = (target - sd.value) / ramp_len;
+                sd.left = ramp_len;
+            }
+            sd.ramping = sd.left > 0;
+            if (!sd.ramping)
+                continue;
+            float *ramp = &ramps[i * MAX_SAMPLE_RUN];
+            uint32_t n = std::min(sd.left, numsamples);
+            float v = sd.value;
+            for (uint32_t j = 0; j < n; j++)
+                ramp[j] = v = v + sd.delta;
+            sd.left -= n;
+            // finished ramping, get rid of accumulated rounding errors
+            if (!sd.left)
+                v = ramp[n - 1] = sd.target;
+            for (uint32_t j = n; j < numsamples; j++)
+                ramp[j] = v;
+            sd.value = v;
+        }
+    }
+    /// Is the value changing within the current block?
+    inline bool is_ramping(int index) const {
+        return data[index].ramping;
+    }
+    /// Value for the whole block if !is_ramping(index), otherwise value at the end of the block
+    inline float get(int index) const {
+        return data[index].value;
+    }
+    /// Value for sample i (counted from the start of the block)
+    inline float get(int index, uint32_t i) const {
+        return data[index].ramping ? ramps[index * MAX_SAMPLE_RUN + i] : data[index].value;
+    }
+    /// Per-sample values for the current block, only valid if is_ramping(index)
+    inline const float *get_ramp(int index) const {
+        return &ramps[index * MAX_SAMPLE_RUN];
+    }
+};
+
 struct debug_send_configure_iface: public send_configure_iface
 {
     void send_configure(const char *key, const char *value)
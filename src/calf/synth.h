@@ -106,8 +106,14 @@ class voice {
 public:
     int sample_rate;
     bool released, sostenuto, stolen;
+    /// Links within the priority list the voice is currently on (managed by basic_synth)
+    voice *prev_voice, *next_voice;
+    /// Priority class of that list, -1 if the voice is not on any list
+    int priority_class;
+    /// Note number the voice was started with (managed by basic_synth)
+    int started_note;
 
-    voice() : sample_rate(-1), released(false), sostenuto(false), stolen(false) {}
+    voice() : sample_rate(-1), released(false), sostenuto(false), stolen(false), prev_voice(NULL), next_voice(NULL), priority_class(-1), started_note(-1) {}
 
     /// reset voice to default state (used when a voice is to be reused)
     virtual void setup(int sr) { sample_rate = sr; }
@@ -126,6 +132,8 @@ public:
     /// return the note used by this voice
     virtual int get_current_note()=0;
     virtual float get_priority() { return stolen ? 20000 : (released ? 1 : (sostenuto ? 200 : 100)); }
+    /// return approximate current output level (used by quietest-first voice stealing)
+    virtual float get_level() { return 1.f; }
     /// empty virtual destructor
     virtual ~voice() {}
 };
@@ -135,28 +143,29 @@ class block_allvoices_base
 {
 public:
     enum { BlockSize = Base::BlockSize, MaxSnapshots = (Base::MaxSampleRun + Base::BlockSize - 1) / Base::BlockSize + 1 };
-    unsigned int sample_ctr;
 
+    /// Make one snapshot per block of a slice (blocks start at the beginning of every slice, see block_voice)
     void fill_snapshots(int nsamples)
     {
-        int s = 0;
-        make_snapshot(s++);
-        while(sample_ctr + nsamples >= Base::BlockSize)
-        {
-            make_snapshot(s++);
-            nsamples -= (Base::BlockSize - sample_ctr);
-            sample_ctr = 0;
-        }
-        sample_ctr += nsamples;
+        make_snapshot(0, std::min<int>(Base::BlockSize, nsamples));
+        for (int s = 1; s * Base::BlockSize < nsamples; s++)
+            make_snapshot(s, std::min<int>(Base::BlockSize, nsamples - s * Base::BlockSize));
     }
-    virtual void make_snapshot(int index) = 0;
+    /// Store the control values for the block index, then advance them by the block length len
+    /// (the last block of a slice may be shorter than BlockSize)
+    virtual void make_snapshot(int index, int len) = 0;
 };
 
 /// An "optimized" voice class using fixed-size processing units
-/// and fixed number of channels. The drawback is that voice
-/// control is not sample-accurate, and no modulation input
-/// is possible, but it should be good enough for most cases
-/// (like Calf Organ).
+/// and fixed number of channels. No modulation input is possible,
+/// but it should be good enough for most cases (like Calf Organ).
+///
+/// Blocks are never rendered past the end of the slice being
+/// processed. Hosts split processing at MIDI event boundaries, so
+/// a block gets cut short wherever an event may occur, and note offs,
+/// stealing etc. take effect at the exact sample instead of on the next
+/// block boundary. Base::render_block must accept any length between
+/// 1 and BlockSize.
 template<class Base>
 class block_voice: public Base {
 public:
@@ -167,37 +176,19 @@ public:
     using Base::BlockSize;
     // float output_buffer[BlockSize][Channels];
     using Base::output_buffer;
-    // void render_block();
+    // void render_block(int snapshot, int len);
     using Base::render_block;
-    unsigned int read_ptr;
 
-    block_voice()
-    {
-        read_ptr = BlockSize;
-    }
-    virtual void reset()
-    {
-        Base::reset();
-        read_ptr = BlockSize;
-    }
     virtual void render_to(float (*buf)[2], int nsamples)
     {
-        int p = 0;
         int current_snapshot = 0;
-        while(p < nsamples)
+        for (int p = 0; p < nsamples; p += BlockSize)
         {
-            if (read_ptr == BlockSize) 
-            {
-                render_block(current_snapshot);
-                current_snapshot++;
-                read_ptr = 0;
-            }
-            int ncopy = std::min<int>(BlockSize - read_ptr, nsamples - p);
-            for (int i = 0; i < ncopy; i++)
+            int len = std::min<int>(BlockSize, nsamples - p);
+            render_block(current_snapshot++, len);
+            for (int i = 0; i < len; i++)
                 for (int c = 0; c < Channels; c++)
-                    buf[p + i][c] += output_buffer[read_ptr + i][c];
-            p += ncopy;
-            read_ptr += ncopy;
+                    buf[p + i][c] += output_buffer[i][c];
         }
     }
 };
@@ -269,15 +260,66 @@ struct basic_pool {
         delete []items;
     }
 };
+/// Intrusive doubly linked list of voices. Voices are appended at the tail,
+/// so the head is always the one that has been on the list for the longest time.
+struct voice_list {
+    voice *head, *tail;
+    unsigned int count;
+
+    voice_list() : head(NULL), tail(NULL), count(0) {}
+    bool empty() const { return head == NULL; }
+    void push_back(voice *v)
+    {
+        v->prev_voice = tail;
+        v->next_voice = NULL;
+        if (tail)
+            tail->next_voice = v;
+        else
+            head = v;
+        tail = v;
+        count++;
+    }
+    void remove(voice *v)
+    {
+        if (v->prev_voice)
+            v->prev_voice->next_voice = v->next_voice;
+        else
+            head = v->next_voice;
+        if (v->next_voice)
+            v->next_voice->prev_voice = v->prev_voice;
+        else
+            tail = v->prev_voice;
+        v->prev_voice = v->next_voice = NULL;
+        count--;
+    }
+};
+
+/// Voice stealing policies
+enum voice_steal_policy {
+    steal_oldest, ///< voice that has been in the lowest priority class for the longest time
+    steal_quietest, ///< voice with the lowest output level within the lowest priority class
+    steal_same_note, ///< voice playing the same note as the new one, otherwise the oldest
+    steal_policy_count
+};
+
 /// Base class for all kinds of polyphonic instruments, provides
 /// somewhat reasonable voice management, pedal support - and 
 /// little else. It's implemented as a base class with virtual
 /// functions, so there's some performance loss, but it shouldn't
 /// be horrible.
+///
+/// Voices are kept in a single preallocated block of memory, and active
+/// voices are additionally kept on intrusive lists, one per priority class
+/// (see get_priority). Priority is only re-evaluated when something
+/// happens to a voice (note off, pedals, stealing) and after rendering
+/// (voices may change their own priority, eg. at the end of a release),
+/// so that finding a voice to steal doesn't involve scanning all voices.
 /// @todo it would make sense to support all notes off controller too
 struct basic_synth {
 protected:
     typedef basic_pool<dsp::voice *> voice_array; 
+    /// Priority classes, in stealing order
+    enum { prio_released, prio_playing, prio_sostenuto, prio_unstealable, prio_count };
     /// Current sample rate
     int sample_rate;
     /// Hold pedal state
@@ -290,24 +332,94 @@ protected:
     voice_array active_voices;
     /// Voices allocated, but not used
     voice_array unused_voices;
+    /// Active voices, by priority class
+    voice_list priority_lists[prio_count];
     /// Gate values for all 128 MIDI notes
     std::bitset<128> gate;
     /// Maximum allocated number of channels
     unsigned int polyphony_limit;
+    /// How to choose a voice to steal
+    voice_steal_policy steal_policy;
+    /// Contiguous block with all the voices
+    voice *voice_arena;
+    /// Function that frees voice_arena (knows the concrete voice type)
+    void (*free_voice_arena)(voice *arena);
 
-    void init_voices(int count);
+    template<class V>
+    static void delete_voice_arena(voice *arena)
+    {
+        delete []static_cast<V *>(arena);
+    }
+    /// Preallocate count voices of type V
+    template<class V>
+    void init_voices(int count)
+    {
+        assert(!voice_arena);
+        V *arena = new V[count];
+        voice_arena = arena;
+        free_voice_arena = &delete_voice_arena<V>;
+        allocated_voices.init(count);
+        active_voices.init(count);
+        unused_voices.init(count);
+        for (int i = 0; i < count; i++)
+        {
+            allocated_voices.add(&arena[i]);
+            unused_voices.add(&arena[i]);
+        }
+    }
+    /// Render all active voices, assuming all of them are of type V (avoids virtual calls per voice)
+    template<class V>
+    void render_voices_of(float (*output)[2], int nsamples)
+    {
+        for (voice_array::iterator i = active_voices.begin(); i != active_voices.end(); ) {
+            V *v = static_cast<V *>(*i);
+            v->V::render_to(output, nsamples);
+            if (!v->V::get_active()) {
+                i = release_voice(i);
+                continue;
+            }
+            update_priority(v);
+            i++;
+        }
+    }
+    static inline int get_priority_class(float priority)
+    {
+        if (priority >= 10000)
+            return prio_unstealable;
+        if (priority < 100)
+            return prio_released;
+        if (priority < 200)
+            return prio_playing;
+        return prio_sostenuto;
+    }
+    /// Put an active voice on the list matching its current priority
+    void update_priority(voice *v);
+    /// Remove voice from the active list (and priority lists) and put it back in the pool
+    voice_array::iterator release_voice(voice_array::iterator i);
+    /// Number of active voices that can still be stolen
+    unsigned int get_stealable_count() const
+    {
+        return priority_lists[prio_released].count + priority_lists[prio_playing].count + priority_lists[prio_sostenuto].count;
+    }
     void kill_note(int note, int vel, bool just_one);
-    virtual dsp::voice *alloc_voice() = 0;
 public:
+    basic_synth()
+    : polyphony_limit((unsigned)-1)
+    , steal_policy(steal_oldest)
+    , voice_arena(NULL)
+    , free_voice_arena(NULL)
+    {}
     virtual void setup(int sr) {
         sample_rate = sr;
         hold = false;
         sostenuto = false;
         polyphony_limit = (unsigned)-1;
     }
+    void set_steal_policy(voice_steal_policy policy) { steal_policy = policy; }
     virtual void trim_voices();
-    virtual dsp::voice *give_voice();
-    virtual void steal_voice();
+    virtual dsp::voice *give_voice(int note);
+    /// Steal a voice according to steal_policy; note is the note that needs the voice (or -1)
+    virtual void steal_voice(int note = -1);
     virtual void render_to(float (*output)[2], int nsamples);
     virtual void note_on(int note, int vel);
     virtual void percussion_note_on(int note, int vel) {}
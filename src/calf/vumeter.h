@@ -109,6 +109,35 @@ struct vumeter
         if (count_over >= 3)
             clip = 1.f;
     }
+    /// Same as calling process() for each of len samples of src multiplied by gain
+    /// (src == NULL means silence), but the peak search is a plain loop over the block
+    /// and the clip counter is only examined when the block goes over 0dB
+    inline void process_block(const float *src, unsigned int len, float gain = 1.f)
+    {
+        if (!len)
+            return;
+        float g = fabs(gain);
+        float peak = 0.f, low = 0.f;
+        if (src) {
+            peak = low = fabs(src[0]);
+            for (unsigned int i = 1; i < len; i++) {
+                float v = fabs(src[i]);
+                peak = std::max(peak, v);
+                low = std::min(low, v);
+            }
+            peak *= g;
+            low *= g;
+        }
+        process_run(src, len, g, peak, low);
+    }
+    /// Same as calling process(value) len times
+    inline void process_constant(float value, unsigned int len)
+    {
+        if (!len)
+            return;
+        float v = fabs(value);
+        process_run(NULL, len, 1.f, v, v);
+    }
     void fall(unsigned int len) {
         // "Age" the old level by falloff^length
         if (reverse)
@@ -120,6 +149,52 @@ struct vumeter
         dsp::sanitize(level);
         dsp::sanitize(clip);
     }
+    /// Update level and clip counter from a block with known extremes; src is only
+    /// scanned to locate the first (or last) sample at which the level crosses 0dB
+    /// (src == NULL means all samples are equal to peak)
+    void process_run(const float *src, unsigned int len, float gain, float peak, float low)
+    {
+        // The level only moves in one direction within a block, so the samples
+        // counted as "over" are a contiguous run at its start or its end
+        if (!reverse) {
+            float new_level = std::max(level, peak);
+            if (new_level <= 1.f) {
+                count_over = 0;
+                level = new_level;
+                return;
+            }
+            // first sample at which the level exceeds 0dB
+            unsigned int first = 0;
+            if (level <= 1.f && src) {
+                while(fabs(src[first]) * gain <= 1.f)
+                    first++;
+                if (first)
+                    count_over = 0;
+            }
+            count_over += len - first;
+            level = new_level;
+        } else {
+            float new_level = std::min(level, low);
+            if (new_level > 1.f) {
+                count_over += len;
+                level = new_level;
+            } else {
+                // number of samples before the level drops to 0dB or below
+                unsigned int over = 0;
+                if (level > 1.f && src) {
+                    while(fabs(src[over]) * gain > 1.f)
+                        over++;
+                }
+                if (count_over + over >= 3 && over)
+                    clip = 1.f;
+                count_over = 0;
+                level = new_level;
+                return;
+            }
+        }
+        if (count_over >= 3)
+            clip = 1.f;
+    }
     /// Update clip meter as if update was called with all-zero input signal
     inline void update_zeros(unsigned int len)
     {
@@ -65,6 +65,8 @@ protected:
     float last_oscamp[OscCount];
     /// Current osc amplitude
     float cur_oscamp[OscCount];
+    /// Velocity-scaled value of amplitude envelope for the current block
+    float amp_env;
     dsp::triangle_lfo lfo1, lfo2;
 public:
     wavetable_voice();
@@ -74,7 +76,17 @@ public:
     void note_off(int /* vel */);
     void channel_pressure(int value);
     void steal();
-    void render_block(int current_snapshot);
+    void render_block(int current_snapshot, int len);
+    /// Advance envelopes and LFOs by a block of len samples and store the modulation
+    /// sources for the coming block in modsrc[0], modsrc[stride], modsrc[2 * stride]...
+    void prepare_block(float *modsrc, int stride, int len);
+    /// Load mod matrix outputs calculated by the parent for the coming block
+    inline void set_moddest(const float *src, int stride) {
+        for (int i = 0; i < wavetable_metadata::moddest_count; i++)
+            moddest[i] = src[i * stride];
+    }
+    /// Render len samples into output_buffer using the current moddest values
+    void render_prepared_block(int current_snapshot, int len);
     const int16_t *get_last_table(int osc) const;
     virtual int get_current_note() {
         return note;
@@ -83,6 +95,9 @@ public:
         // printf("note %d getactive %d use_percussion %d pamp active %d\n", note, amp.get_active(), use_percussion(), pamp.get_active());
         return (note != -1) && (amp.get_active()) && !envs[0].stopped();
     }
+    virtual float get_level() {
+        return amp_env;
+    }
     inline void calc_derived_dests(float env0) {
         float cv = dsp::clip<float>(0.5 + 0.01 * moddest[wavetable_metadata::moddest_oscmix], 0.f, 1.f);
         float overall = *params[wavetable_metadata::par_eg1toamp] > 0 ? env0 : 1.0;
@@ -99,9 +114,19 @@ public:
     using dsp::basic_synth::control_change;
     using dsp::basic_synth::pitch_bend;
 
+    enum { VoiceCount = 36, BlockSize = wavetable_voice::BlockSize };
 protected:
     uint32_t crate;
     bool panic_flag;
+    /// Modulation sources of all active voices, source-major
+    float batch_modsrc[modsrc_count][VoiceCount];
+    /// Modulation destinations of all active voices, destination-major
+    float batch_moddest[moddest_count][VoiceCount];
+
+    /// Render next block of all active voices, with one mod matrix pass for all of them
+    void render_voice_blocks(int current_snapshot, int len);
+    /// Render and mix all active voices, all of them use the same block boundaries
+    void render_voices(float (*buf)[2], int nsamples);
 
 public:
     int16_t tables[wt_count][129][256]; // one dummy level for interpolation
@@ -124,12 +149,6 @@ public:
 public:
     wavetable_audio_module();
 
-    dsp::voice *alloc_voice() {
-        dsp::block_voice<wavetable_voice> *v = new dsp::block_voice<wavetable_voice>();
-        v->set_params_ptr(this, sample_rate);
-        return v;
-    }
-    
     uint32_t get_crate() const { return crate; }
     
     /// process function copied from Organ (will probably need some adjustments as well as implementing the panic flag elsewhere
@@ -145,7 +164,7 @@ public:
         fill_snapshots(nsamples);
         float buf[MAX_SAMPLE_RUN][2];
         dsp::zero(&buf[0][0], 2 * nsamples);
-        basic_synth::render_to(buf, nsamples);
+        render_voices(buf, nsamples);
         if (!active_voices.empty())
             last_voice = (wavetable_voice *)*active_voices.begin();
         float gain = 1.0f;
@@ -156,19 +175,22 @@ public:
         return 3;
     }
     
-    void make_snapshot(int index)
+    void make_snapshot(int index, int len)
     {
-        if (index)
-            control_snapshots[index].pitchbend = inertia_pitchbend.get();
-        else
-            control_snapshots[0].pitchbend = inertia_pitchbend.get_last();
+        control_snapshots[index].pitchbend = inertia_pitchbend.get_last();
+        // ramps are counted in samples, so that short blocks don't speed them up
+        inertia_pitchbend.step_many(len);
+        inertia_pressure.step_many(len);
     }
 
     void set_sample_rate(uint32_t sr) {
         setup(sr);
         crate = sample_rate / wavetable_voice::BlockSize;
-        inertia_pitchbend.ramp.set_length(crate / 30); // 1/30s    
-        inertia_pressure.ramp.set_length(crate / 30); // 1/30s - XXXKF monosynth needs that too
+        inertia_pitchbend.ramp.set_length(sample_rate / 30); // 1/30s    
+        inertia_pressure.ramp.set_length(sample_rate / 30); // 1/30s - XXXKF monosynth needs that too
+    }
+    void params_changed() {
+        set_steal_policy((dsp::voice_steal_policy)dsp::clip(dsp::fastf2i_drm(*params[par_steal]), 0, dsp::steal_policy_count - 1));
     }
     virtual void note_on(int channel, int note, int velocity) { if (*params[par_midi] && channel != *params[par_midi]) return; dsp::basic_synth::note_on(note, velocity); }
     virtual void note_off(int channel, int note, int velocity) { if (*params[par_midi] && channel != *params[par_midi]) return; dsp::basic_synth::note_off(note, velocity); }
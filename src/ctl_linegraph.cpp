@@ -30,6 +30,7 @@
 #include <calf/giface.h>
 #include <stdint.h>
 #include <algorithm>
+#include <list>
 
 #define RGBAtoINT(r, g, b, a) ((uint32_t)(r * 255) << 24) + ((uint32_t)(g * 255) << 16) + ((uint32_t)(b * 255) << 8) + (uint32_t)(a * 255)
 #define INTtoR(color) (float)((color & 0xff000000) >> 24) / 255.f
@@ -483,6 +484,59 @@ void calf_line_graph_draw_freqhandles(CalfLineGraph* lg, cairo_t* c)
     }
 }
 
+/// Everything the background of a line graph depends on, including the
+/// theme colours (the style can be switched at runtime)
+struct line_graph_background_key
+{
+    int width, height, pad_x, pad_y;
+    float radius, bevel, shadow, lights, dull;
+    float bg[3], base[3];
+    bool operator==(const line_graph_background_key &k) const {
+        return width == k.width && height == k.height && pad_x == k.pad_x && pad_y == k.pad_y
+            && radius == k.radius && bevel == k.bevel && shadow == k.shadow && lights == k.lights && dull == k.dull
+            && !memcmp(bg, k.bg, sizeof(bg)) && !memcmp(base, k.base, sizeof(base));
+    }
+};
+
+/// Background surfaces shared between graphs of the same size and style,
+/// the list holds one reference to each of them
+static list<pair<line_graph_background_key, cairo_surface_t *> > line_graph_backgrounds;
+
+static cairo_surface_t *
+calf_line_graph_acquire_background(GtkWidget *widget, const line_graph_background_key &key)
+{
+    typedef list<pair<line_graph_background_key, cairo_surface_t *> >::iterator iter;
+    for (iter i = line_graph_backgrounds.begin(); i != line_graph_backgrounds.end(); ++i) {
+        if (i->first == key)
+            return cairo_surface_reference(i->second);
+    }
+    CalfLineGraph *lg = CALF_LINE_GRAPH(widget);
+    if (lg->debug) printf("(draw background)\n");
+    // the yellowish lighting and the frame are static, so they are
+    // drawn only once per size and style
+    cairo_surface_t *bg = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, key.width, key.height);
+    cairo_t *c = cairo_create(bg);
+    display_background(widget, c, 0, 0, key.width - key.pad_x * 2, key.height - key.pad_y * 2, key.pad_x, key.pad_y, key.radius, key.bevel, 1, key.shadow, key.lights, key.dull);
+    cairo_destroy(c);
+    line_graph_backgrounds.push_back(make_pair(key, bg));
+    return cairo_surface_reference(bg);
+}
+
+static void
+calf_line_graph_release_background(cairo_surface_t *bg)
+{
+    typedef list<pair<line_graph_background_key, cairo_surface_t *> >::iterator iter;
+    for (iter i = line_graph_backgrounds.begin(); i != line_graph_backgrounds.end(); ++i) {
+        // only the cache's own reference is left after this one is gone
+        if (i->second == bg && cairo_surface_get_reference_count(bg) == 2) {
+            cairo_surface_destroy(bg);
+            line_graph_backgrounds.erase(i);
+            break;
+        }
+    }
+    cairo_surface_destroy(bg);
+}
+
 static void
 calf_line_graph_destroy_surfaces (GtkWidget *widget)
 {
@@ -493,7 +547,7 @@ calf_line_graph_destroy_surfaces (GtkWidget *widget)
     
     // destroy all surfaces - and don't tell anybody about it - hehe
     if( lg->background_surface )
-        cairo_surface_destroy( lg->background_surface );
+        calf_line_graph_release_background( lg->background_surface );
     if( lg->grid_surface )
         cairo_surface_destroy( lg->grid_surface );
     if( lg->cache_surface )
@@ -506,6 +560,13 @@ calf_line_graph_destroy_surfaces (GtkWidget *widget)
         cairo_surface_destroy( lg->handles_surface );
     if( lg->realtime_surface )
         cairo_surface_destroy( lg->realtime_surface );
+    lg->background_surface = NULL;
+    lg->grid_surface       = NULL;
+    lg->cache_surface      = NULL;
+    lg->moving_surface[0]  = NULL;
+    lg->moving_surface[1]  = NULL;
+    lg->handles_surface    = NULL;
+    lg->realtime_surface   = NULL;
 }
 static void
 calf_line_graph_create_surfaces (GtkWidget *widget)
@@ -523,11 +584,19 @@ calf_line_graph_create_surfaces (GtkWidget *widget)
     lg->size_y = height - lg->pad_y * 2;
         
     calf_line_graph_destroy_surfaces(widget);
-    // create the background surface.
+    // get the background surface.
     // background holds the graphics of the frame and the yellowish
-    // background light for faster redrawing of static stuff
-    lg->background_surface = cairo_image_surface_create(
-        CAIRO_FORMAT_ARGB32, width, height );
+    // background light for faster redrawing of static stuff. It is
+    // shared with all other graphs of the same size and style.
+    line_graph_background_key key;
+    key.width  = width;
+    key.height = height;
+    key.pad_x  = lg->pad_x;
+    key.pad_y  = lg->pad_y;
+    gtk_widget_style_get(widget, "border-radius", &key.radius, "bevel",  &key.bevel, "shadow", &key.shadow, "lights", &key.lights, "dull", &key.dull, NULL);
+    get_bg_color(widget, NULL, &key.bg[0], &key.bg[1], &key.bg[2]);
+    get_base_color(widget, NULL, &key.base[0], &key.base[1], &key.base[2]);
+    lg->background_surface = calf_line_graph_acquire_background(widget, key);
     
     // create the grid surface.
     // this one is used as a cache for the grid on the background in the
@@ -542,23 +611,13 @@ calf_line_graph_create_surfaces (GtkWidget *widget)
     lg->cache_surface = cairo_image_surface_create(
         CAIRO_FORMAT_ARGB32, width, height );
     
-    // create the moving surface.
-    // moving is used as a cache for any slowly moving graphics like
-    // spectralizer or waveforms
-    lg->moving_surface[0] = cairo_image_surface_create(
-        CAIRO_FORMAT_ARGB32, width, height );
-    
-    // create the moving temp surface.
-    // moving is used as a cache for any slowly moving graphics like
-    // spectralizer or waveforms
-    lg->moving_surface[1] = cairo_image_surface_create(
-        CAIRO_FORMAT_ARGB32, width, height );
+    // the moving surfaces are only needed by graphs with moving
+    // layers (spectralizer, waveforms), they are created on first use
+    // in calf_line_graph_create_moving_surfaces
         
-    // create the handles surface.
-    // this one contains the handles graphics to avoid redrawing
-    // each cycle
-    lg->handles_surface = cairo_image_surface_create(
-        CAIRO_FORMAT_ARGB32, width, height );
+    // the handles surface contains the handles graphics to avoid
+    // redrawing each cycle, it is created on first use in the expose
+    // handler of graphs with frequency handles
         
     // create the realtime surface.
     // realtime is used to cache the realtime graphics for drawing the
@@ -566,6 +625,14 @@ calf_line_graph_create_surfaces (GtkWidget *widget)
     lg->realtime_surface = cairo_image_surface_create(
         CAIRO_FORMAT_ARGB32, width, height );
         
+    // the buffer for curve data handed over to the plugin
+    int data_size = 2 * std::max(lg->size_x, lg->size_y);
+    if (data_size > lg->graph_data_size) {
+        delete []lg->graph_data;
+        lg->graph_data = new float[data_size];
+        lg->graph_data_size = data_size;
+    }
+        
     lg->force_cache = true;
 }
 
@@ -608,6 +675,25 @@ calf_line_graph_clear_surface(cairo_t *ctx)
     cairo_restore (ctx);
 }
 
+static void
+calf_line_graph_create_moving_surfaces (CalfLineGraph *lg)
+{
+    if (lg->moving_surface[0])
+        return;
+    int width  = cairo_image_surface_get_width(lg->cache_surface);
+    int height = cairo_image_surface_get_height(lg->cache_surface);
+    // moving is used as a cache for any slowly moving graphics like
+    // spectralizer or waveforms, the second one is the temp surface
+    // for scrolling
+    for (int i = 0; i < 2; i++) {
+        lg->moving_surface[i] = cairo_image_surface_create(
+            CAIRO_FORMAT_ARGB32, width, height );
+        cairo_t *c = cairo_create(lg->moving_surface[i]);
+        calf_line_graph_clear_surface(c);
+        cairo_destroy(c);
+    }
+}
+
 void calf_line_graph_expose_request (GtkWidget *widget, bool force)
 {
     // someone thinks we should redraw the line graph. let's see what
@@ -619,8 +705,10 @@ void calf_line_graph_expose_request (GtkWidget *widget, bool force)
     g_assert(CALF_IS_LINE_GRAPH(widget));
     CalfLineGraph *lg = CALF_LINE_GRAPH(widget);
     
-    // quit if no source available
-    if (!lg->source) return;
+    // quit if no source available or if the graph isn't visible at the
+    // moment (eg. on a hidden notebook page) - it will be exposed anyway
+    // as soon as it is shown
+    if (!lg->source || !GTK_WIDGET_DRAWABLE(widget)) return;
     
     if (lg->debug > 1) printf("\n\n### expose request %d ###\n", lg->generation);
     
@@ -641,8 +729,13 @@ void calf_line_graph_expose_request (GtkWidget *widget, bool force)
     // if plugin returns true (something has obviously changed) or if
     // the requestor forces a redraw, request an exposition of the widget
     // from GTK
-    if (lg->source->get_layers(lg->source_id, lg->generation, lg->layers) or force)
+    // the frame around the graph is static, so only the drawing area
+    // is invalidated unless the surfaces are about to be recreated
+    bool redraw = lg->source->get_layers(lg->source_id, lg->generation, lg->layers);
+    if (force or lg->recreate_surfaces)
         gtk_widget_queue_draw(widget);
+    else if (redraw)
+        gtk_widget_queue_draw_area(widget, widget->allocation.x + lg->pad_x, widget->allocation.y + lg->pad_y, lg->size_x, lg->size_y);
 }
 
 static gboolean
@@ -656,8 +749,11 @@ calf_line_graph_expose (GtkWidget *widget, GdkEventExpose *event)
     
     if (lg->debug) printf("\n\n####### exposing %d #######\n", lg->generation);
     
-    // cairo context of the window
+    // cairo context of the window, limited to the region that actually
+    // needs to be repainted
     cairo_t *c            = gdk_cairo_create(GDK_DRAWABLE(widget->window));
+    gdk_cairo_region(c, event->region);
+    cairo_clip(c);
     
     
     // recreate surfaces if someone needs it (init of the widget,
@@ -667,18 +763,9 @@ calf_line_graph_expose (GtkWidget *widget, GdkEventExpose *event)
         lg->pad_y = widget->style->ythickness;
         lg->x = widget->allocation.x;
         lg->y = widget->allocation.y;
-        float radius, bevel, shadow, lights, dull;
-        gtk_widget_style_get(widget, "border-radius", &radius, "bevel",  &bevel, "shadow", &shadow, "lights", &lights, "dull", &dull, NULL);
-    
+        
         if (lg->debug) printf("recreation...\n");
         calf_line_graph_create_surfaces(widget);
-        
-        // all surfaces were recreated, so background is empty.
-        // draw the yellowish lighting on the background surface
-        cairo_t *bg = cairo_create(lg->background_surface);
-        if (lg->debug) printf("(draw background)\n");
-        display_background(widget, bg, 0, 0, lg->size_x, lg->size_y, lg->pad_x, lg->pad_y, radius, bevel, 1, shadow, lights, dull);
-        cairo_destroy(bg);
     }
     
     // the cache, grid and realtime surface wrapped in a cairo context
@@ -724,9 +811,12 @@ calf_line_graph_expose (GtkWidget *widget, GdkEventExpose *event)
     cairo_t *_ctx = NULL;
     
     // the contexts for both moving curve caches
-    cairo_t *moving_c[2];
-    moving_c[0]           = cairo_create( lg->moving_surface[0] );
-    moving_c[1]           = cairo_create( lg->moving_surface[1] );
+    cairo_t *moving_c[2] = { NULL, NULL };
+    if (lg->layers & (LG_CACHE_MOVING | LG_REALTIME_MOVING)) {
+        calf_line_graph_create_moving_surfaces(lg);
+        moving_c[0]       = cairo_create( lg->moving_surface[0] );
+        moving_c[1]       = cairo_create( lg->moving_surface[1] );
+    }
     
     // the line widths to switch to between cycles
     float grid_width  = 1.0;
@@ -735,7 +825,7 @@ calf_line_graph_expose (GtkWidget *widget, GdkEventExpose *event)
     
     // more vars we have to initialize, mainly stuff we use in callback
     // functions
-    float *data        = new float[2 * std::max(lg->size_x, lg->size_y)];
+    float *data        = lg->graph_data;
     float pos          = 0;
     bool vertical      = false;
     string legend = "";
@@ -1044,7 +1134,6 @@ calf_line_graph_expose (GtkWidget *widget, GdkEventExpose *event)
     
     
     finalize:
-    delete[] data;
     if (lg->debug) printf("\n### finalize\n");
     
     // whatever happened - we need to copy the realtime surface to the
@@ -1056,6 +1145,12 @@ calf_line_graph_expose (GtkWidget *widget, GdkEventExpose *event)
     
     // if someone changed the handles via drag'n'drop or externally we
     // need a redraw of the handles surface
+    if (lg->freqhandles and !lg->handles_surface) {
+        lg->handles_surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+            cairo_image_surface_get_width(lg->realtime_surface),
+            cairo_image_surface_get_height(lg->realtime_surface));
+        lg->handle_redraw = 1;
+    }
     if (lg->freqhandles and (lg->handle_redraw or lg->force_redraw)) {
         cairo_t *hs = cairo_create(lg->handles_surface);
         calf_line_graph_clear_surface(hs);
@@ -1090,8 +1185,10 @@ calf_line_graph_expose (GtkWidget *widget, GdkEventExpose *event)
     cairo_destroy(realtime_c);
     cairo_destroy(grid_c);
     cairo_destroy(cache_c);
-    cairo_destroy(moving_c[0]);
-    cairo_destroy(moving_c[1]);
+    if (moving_c[0]) {
+        cairo_destroy(moving_c[0]);
+        cairo_destroy(moving_c[1]);
+    }
     
     lg->generation += 1;
     
@@ -1436,6 +1533,10 @@ calf_line_graph_unrealize (GtkWidget *widget, CalfLineGraph *lg)
 {
     if (lg->debug) printf("unrealize\n");
     calf_line_graph_destroy_surfaces(widget);
+    delete []lg->graph_data;
+    lg->graph_data = NULL;
+    lg->graph_data_size = 0;
+    lg->recreate_surfaces = 1;
 }
 
 static void
@@ -1497,6 +1598,8 @@ calf_line_graph_init (CalfLineGraph *lg)
     lg->moving_surface[1]  = NULL;
     lg->handles_surface    = NULL;
     lg->realtime_surface   = NULL;
+    lg->graph_data         = NULL;
+    lg->graph_data_size    = 0;
     
     gtk_event_box_set_visible_window(GTK_EVENT_BOX(widget), FALSE);
     //gtk_widget_set_has_window(widget, FALSE);
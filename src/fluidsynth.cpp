@@ -22,6 +22,9 @@
 #include <calf/modules_dev.h>
 #include <calf/utils.h>
 #include <string.h>
+#include <errno.h>
+#include <list>
+#include <sys/stat.h>
 
 #if ENABLE_EXPERIMENTAL
 
@@ -31,10 +34,138 @@ using namespace std;
 
 FORWARD_DECLARE_METADATA(fluidsynth)
 
+static calf_utils::ptmutex soundfont_cache_mutex;
+static std::list<shared_soundfont *> soundfont_cache_entries;
+
+shared_soundfont *soundfont_cache::acquire(const std::string &path)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st))
+        return NULL;
+    
+    calf_utils::ptlock lock(soundfont_cache_mutex);
+    for (list<shared_soundfont *>::iterator i = soundfont_cache_entries.begin(); i != soundfont_cache_entries.end(); ++i)
+    {
+        if ((*i)->path == path && (*i)->mtime == st.st_mtime)
+        {
+            (*i)->refcount++;
+            return *i;
+        }
+    }
+    
+    // The holder synth keeps the soundfont loaded for as long as any instance
+    // uses it. FluidSynth shares sample data between all synths that load the
+    // same, unmodified file, so instance synths only add their own preset tables.
+    shared_soundfont *sf = new shared_soundfont;
+    sf->path = path;
+    sf->mtime = st.st_mtime;
+    sf->refcount = 1;
+    sf->settings = new_fluid_settings();
+    fluid_settings_setint(sf->settings, "synth.polyphony", 1);
+    sf->holder = new_fluid_synth(sf->settings);
+    sf->first_preset = -1;
+    int sid = fluid_synth_sfload(sf->holder, path.c_str(), 0);
+    if (sid == -1)
+    {
+        delete_fluid_synth(sf->holder);
+        delete_fluid_settings(sf->settings);
+        delete sf;
+        return NULL;
+    }
+
+    fluid_sfont_t* sfont = fluid_synth_get_sfont_by_id(sf->holder, sid);
+#if FLUIDSYNTH_VERSION_MAJOR < 2
+    sf->name = (*sfont->get_name)(sfont);
+
+    sfont->iteration_start(sfont);
+    
+    fluid_preset_t tmp;
+    while(sfont->iteration_next(sfont, &tmp))
+    {
+        string pname = tmp.get_name(&tmp);
+        int bank = tmp.get_banknum(&tmp);
+        int num = tmp.get_num(&tmp);
+        int id = num + 128 * bank;
+        sf->preset_names[id] = pname;
+        sf->preset_list += calf_utils::i2s(id) + "\t" + pname + "\n";
+        if (sf->first_preset == -1)
+            sf->first_preset = id;
+    }
+#else
+    sf->name = fluid_sfont_get_name(sfont);
+
+    fluid_sfont_iteration_start(sfont);
+
+    fluid_preset_t* tmp;
+    while((tmp = fluid_sfont_iteration_next(sfont)))
+    {
+        string pname = fluid_preset_get_name(tmp);
+        int bank = fluid_preset_get_banknum(tmp);
+        int num = fluid_preset_get_num(tmp);
+        int id = num + 128 * bank;
+        sf->preset_names[id] = pname;
+        sf->preset_list += calf_utils::i2s(id) + "\t" + pname + "\n";
+        if (sf->first_preset == -1)
+            sf->first_preset = id;
+    }
+#endif
+    soundfont_cache_entries.push_back(sf);
+    return sf;
+}
+
+shared_soundfont *soundfont_cache::acquire_ref(shared_soundfont *const &sf)
+{
+    calf_utils::ptlock lock(soundfont_cache_mutex);
+    // the owner releases its old soundfont only while holding the lock, so
+    // whatever sf points to now still has a reference
+    shared_soundfont *cur_sf = sf;
+    if (cur_sf)
+        cur_sf->refcount++;
+    return cur_sf;
+}
+
+void soundfont_cache::release(shared_soundfont *sf)
+{
+    if (!sf)
+        return;
+    calf_utils::ptlock lock(soundfont_cache_mutex);
+    if (--sf->refcount)
+        return;
+    soundfont_cache_entries.remove(sf);
+    delete_fluid_synth(sf->holder);
+    delete_fluid_settings(sf->settings);
+    delete sf;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 fluidsynth_audio_module::fluidsynth_audio_module()
 {
     settings = NULL;
     synth = NULL;
+    sf = NULL;
+    sfid = -1;
+    soundfont_loaded = false;
+    load_state = load_idle;
+    load_thread_started = false;
+    load_quit = false;
+    soundfont[0] = '\0';
+    for (int i = 0; i < 3; i++)
+    {
+        load_request_type &req = load_requests.get_slot(i);
+        req.path[0] = '\0';
+        req.too_long = false;
+        req.serial = 0;
+    }
+    request_serial = 0;
+    picked_serial = 0;
+    done_serial = 0;
+    load_progress = -1;
+    sem_init(&load_sem, 0, 0);
+    pending_synth = NULL;
+    pending_sf = NULL;
+    pending_sfid = -1;
+    pending_serial = 0;
     status_serial = 1;
     std::fill(set_presets, set_presets + 16, -1);
     std::fill(last_selected_presets, last_selected_presets + 16, -1);
@@ -44,8 +175,15 @@ void fluidsynth_audio_module::post_instantiate(uint32_t sr)
 {
     srate = sr;
     settings = new_fluid_settings();
-    synth = create_synth(sfid);
-    soundfont_loaded = sfid != -1;
+    // start with a blank synth, the soundfont is swapped in when it's ready
+    synth = create_synth(NULL, sfid);
+    soundfont_loaded = false;
+    load_thread_started = !pthread_create(&load_thread, NULL, loader_thread, this);
+    // pick up the soundfont configured before instantiation, if any
+    if (load_thread_started)
+        sem_post(&load_sem);
+    else
+        load_step();
 }
 
 void fluidsynth_audio_module::activate()
@@ -56,77 +194,126 @@ void fluidsynth_audio_module::deactivate()
 {
 }
 
-fluid_synth_t *fluidsynth_audio_module::create_synth(int &new_sfid)
+/// Delete an instance synth together with the settings object create_synth made for it
+static void delete_synth(fluid_synth_t *s)
+{
+    fluid_settings_t *s_settings = fluid_synth_get_settings(s);
+    delete_fluid_synth(s);
+    delete_fluid_settings(s_settings);
+}
+
+fluid_synth_t *fluidsynth_audio_module::create_synth(shared_soundfont *new_sf, int &new_sfid)
 {
-    std::fill(set_presets, set_presets + 16, -1);
     fluid_settings_t *new_settings = new_fluid_settings();
     fluid_settings_setnum(new_settings, "synth.sample-rate", srate);
     fluid_synth_t *s = new_fluid_synth(new_settings);
-    if (!soundfont.empty())
+    if (new_sf)
     {
-        int sid = fluid_synth_sfload(s, soundfont.c_str(), 1);
+        int sid = fluid_synth_sfload(s, new_sf->path.c_str(), 1);
         if (sid == -1)
         {
-            delete_fluid_synth(s);
+            delete_synth(s);
             return NULL;
         }
         assert(sid >= 0);
-        printf("sid=%d\n", sid);
         fluid_synth_sfont_select(s, 0, sid);
         new_sfid = sid;
 
-        fluid_sfont_t* sfont = fluid_synth_get_sfont(s, 0);
-#if FLUIDSYNTH_VERSION_MAJOR < 2
-        soundfont_name = (*sfont->get_name)(sfont);
-
-        sfont->iteration_start(sfont);
-        
-        string preset_list;
-        fluid_preset_t tmp;
-        int first_preset = -1;
-        while(sfont->iteration_next(sfont, &tmp))
+        if (new_sf->first_preset != -1)
         {
-            string pname = tmp.get_name(&tmp);
-            int bank = tmp.get_banknum(&tmp);
-            int num = tmp.get_num(&tmp);
-            int id = num + 128 * bank;
-            sf_preset_names[id] = pname;
-            preset_list += calf_utils::i2s(id) + "\t" + pname + "\n";
-            if (first_preset == -1)
-                first_preset = id;
+            fluid_synth_bank_select(s, 0, new_sf->first_preset >> 7);
+            fluid_synth_program_change(s, 0, new_sf->first_preset & 127);        
         }
-#else
-        soundfont_name = fluid_sfont_get_name(sfont);
-
-        fluid_sfont_iteration_start(sfont);
-
-        string preset_list;
-        fluid_preset_t* tmp;
-        int first_preset = -1;
-        while((tmp = fluid_sfont_iteration_next(sfont)))
-        {
-            string pname = fluid_preset_get_name(tmp);
-            int bank = fluid_preset_get_banknum(tmp);
-            int num = fluid_preset_get_num(tmp);
-            int id = num + 128 * bank;
-            sf_preset_names[id] = pname;
-            preset_list += calf_utils::i2s(id) + "\t" + pname + "\n";
-            if (first_preset == -1)
-                first_preset = id;
-        }
-#endif
-        if (first_preset != -1)
-        {
-            fluid_synth_bank_select(s, 0, first_preset >> 7);
-            fluid_synth_program_change(s, 0, first_preset & 127);        
-        }
-        soundfont_preset_list = preset_list;
     }
     else
         new_sfid = -1;
     return s;
 }
 
+void *fluidsynth_audio_module::loader_thread(void *arg)
+{
+    fluidsynth_audio_module *self = (fluidsynth_audio_module *)arg;
+    while(true)
+    {
+        while(sem_wait(&self->load_sem) == -1 && errno == EINTR)
+            ;
+        if (self->load_quit)
+            break;
+        self->load_step();
+    }
+    return NULL;
+}
+
+void fluidsynth_audio_module::request_load()
+{
+    // without a loader thread, send_status_updates does the loading
+    if (load_thread_started)
+        sem_post(&load_sem);
+}
+
+void fluidsynth_audio_module::set_load_progress(int progress, const std::string &message)
+{
+    calf_utils::ptlock lock(load_mutex);
+    load_progress = progress;
+    load_message = message;
+}
+
+void fluidsynth_audio_module::load_step()
+{
+    if (load_state == load_swapped)
+    {
+        // the pending_ variables hold the synth that process() has replaced
+        if (pending_synth)
+            delete_synth(pending_synth);
+        soundfont_cache::release(pending_sf);
+        pending_synth = NULL;
+        pending_sf = NULL;
+        __sync_synchronize();
+        load_state = load_idle;
+    }
+    // process() hasn't taken the previous synth yet - it will wake us up when it does
+    if (load_state != load_idle)
+        return;
+    // only the latest request matters, the ones it has superseded are skipped
+    const load_request_type &req = load_requests.get_read();
+    if (req.serial == picked_serial)
+        return;
+    picked_serial = req.serial;
+    std::string path = req.path;
+    shared_soundfont *new_sf = NULL;
+    fluid_synth_t *new_synth = NULL;
+    int new_sfid = -1;
+    if (path.empty())
+        printf("Creating a blank synth\n");
+    else
+    {
+        printf("Loading %s\n", path.c_str());
+        set_load_progress(0, "Loading soundfont " + path);
+        if (!req.too_long)
+            new_sf = soundfont_cache::acquire(path);
+    }
+    if (new_sf || path.empty())
+        new_synth = create_synth(new_sf, new_sfid);
+    if (new_synth)
+    {
+        pending_synth = new_synth;
+        pending_sf = new_sf;
+        pending_sfid = new_sfid;
+        pending_serial = picked_serial;
+        __sync_synchronize();
+        load_state = load_ready;
+        set_load_progress(100, "");
+    }
+    else
+    {
+        soundfont_cache::release(new_sf);
+        // the current synth stays, so the presets waiting for this load can go to it
+        done_serial = picked_serial;
+        printf("Cannot load soundfont %s\n", path.c_str());
+        set_load_progress(100, "Cannot load a soundfont");
+    }
+}
+
 void fluidsynth_audio_module::note_on(int channel, int note, int vel)
 {
     fluid_synth_noteon(synth, channel, note, vel);
@@ -177,10 +364,28 @@ void fluidsynth_audio_module::select_preset_in_channel(int channel, int new_pres
 uint32_t fluidsynth_audio_module::process(uint32_t offset, uint32_t nsamples, uint32_t inputs_mask, uint32_t outputs_mask)
 {
     static const int interp_lens[] = { 0, 1, 4, 7 };
+    // pick up a synth prepared by the loader thread, and let it delete the old one (never blocks)
+    if (load_state == load_ready)
+    {
+        std::swap(synth, pending_synth);
+        std::swap(sf, pending_sf);
+        std::swap(sfid, pending_sfid);
+        soundfont_loaded = sfid != -1;
+        done_serial = pending_serial;
+        for (int i = 0; i < 16; ++i)
+            update_preset_num(i);
+        __sync_synchronize();
+        load_state = load_swapped;
+        if (load_thread_started)
+            sem_post(&load_sem);
+    }
+    // presets selected after requesting a soundfont are meant for the new synth,
+    // so keep them until it is swapped in (create_synth resets the presets)
+    bool load_pending = done_serial != request_serial;
     for (int i = 0; i < 16; ++i)
     {
         int new_preset = set_presets[i];
-        if (new_preset != -1 && soundfont_loaded)
+        if (new_preset != -1 && soundfont_loaded && !load_pending)
         {
             // XXXKF yeah there's a tiny chance of race here, have to live with it until I write some utility classes for lock-free data passing
             set_presets[i] = -1;
@@ -213,42 +418,32 @@ char *fluidsynth_audio_module::configure(const char *key, const char *value)
     }
     if (!strcmp(key, "soundfont"))
     {
-        if (value && *value)
-        {
-            printf("Loading %s\n", value);
-            soundfont = value;
-        }
-        else
-        {
-            printf("Creating a blank synth\n");
-            soundfont.clear();
-        }
-        // First synth not yet created - defer creation up to post_instantiate
+        // this may run in the audio thread, so the filename is only copied into
+        // preallocated buffers here, checking, loading and reporting is done by
+        // the loader thread
+        if (!value)
+            value = "";
+        size_t len = strlen(value);
+        load_request_type &req = load_requests.get_write();
+        req.too_long = len >= sizeof(req.path);
+        if (req.too_long)
+            len = sizeof(req.path) - 1;
+        memcpy(req.path, value, len);
+        req.path[len] = '\0';
+        memcpy(soundfont, req.path, len + 1);
+        req.serial = ++request_serial;
+        load_requests.publish();
+        // First synth not yet created - defer loading up to post_instantiate
         if (!synth)
             return NULL;
-        int newsfid = -1;
-        fluid_synth_t *new_synth = create_synth(newsfid);
-        soundfont_loaded = newsfid != -1;
-
-        status_serial++;
-        
-        if (new_synth)
-        {
-            synth = new_synth;
-            sfid = newsfid;
-            for (int i = 0; i < 16; ++i)
-                update_preset_num(i);
-        }
-        else
-            return strdup("Cannot load a soundfont");
-        // XXXKF memory leak
+        request_load();
     }
     return NULL;
 }
 
 void fluidsynth_audio_module::send_configures(send_configure_iface *sci)
 {
-    sci->send_configure("soundfont", soundfont.c_str());
+    sci->send_configure("soundfont", soundfont);
     sci->send_configure("preset_key_set", calf_utils::i2s(last_selected_presets[0]).c_str());
     for (int i = 1; i < 16; ++i)
     {
@@ -259,31 +454,72 @@ void fluidsynth_audio_module::send_configures(send_configure_iface *sci)
 
 int fluidsynth_audio_module::send_status_updates(send_updates_iface *sui, int last_serial)
 {
+    // status updates are polled from a non-realtime thread, so this is a good
+    // place to report a completed background load (and to do the loading
+    // if there is no loader thread)
+    if (!load_thread_started)
+        load_step();
+    int progress;
+    std::string message;
+    {
+        calf_utils::ptlock lock(load_mutex);
+        progress = load_progress;
+        message = load_message;
+        load_progress = -1;
+    }
+    if (progress != -1)
+    {
+        // the progress window belongs to the GUI, so it is never updated from the loader thread
+        if (progress_report)
+            progress_report->report_progress(progress, message);
+        if (progress == 100)
+            status_serial++;
+    }
     int cur_serial = status_serial;
     if (cur_serial != last_serial)
     {
-        sui->send_status("sf_name", soundfont_name.c_str());
-        sui->send_status("preset_list", soundfont_preset_list.c_str());
+        // process() may swap sf out and the loader thread release it at any
+        // time, so the soundfont is only looked at through a reference of our own
+        shared_soundfont *cur_sf = soundfont_cache::acquire_ref(sf);
+        sui->send_status("sf_name", cur_sf ? cur_sf->name.c_str() : "");
+        sui->send_status("preset_list", cur_sf ? cur_sf->preset_list.c_str() : "");
         for (int i = 0; i < 16; ++i)
         {
             string id = i ? calf_utils::i2s(i + 1) : string();
             string key = "preset_key" + id;
             sui->send_status(key.c_str(), calf_utils::i2s(last_selected_presets[i]).c_str());
             key = "preset_name" + id;
-            map<uint32_t, string>::const_iterator it = sf_preset_names.find(last_selected_presets[i]);
-            if (it == sf_preset_names.end())
+            map<uint32_t, string>::const_iterator it;
+            if (!cur_sf || (it = cur_sf->preset_names.find(last_selected_presets[i])) == cur_sf->preset_names.end())
                 sui->send_status(key.c_str(), "");
             else
                 sui->send_status(key.c_str(), it->second.c_str());
         }
+        soundfont_cache::release(cur_sf);
     }
     return cur_serial;
 }
 
 fluidsynth_audio_module::~fluidsynth_audio_module()
 {
+    if (load_thread_started)
+    {
+        load_quit = true;
+        sem_post(&load_sem);
+        pthread_join(load_thread, NULL);
+    }
+    sem_destroy(&load_sem);
+    // a synth that process() has never taken, or the one it has replaced
+    if (load_state != load_idle)
+    {
+        if (pending_synth)
+            delete_synth(pending_synth);
+        soundfont_cache::release(pending_sf);
+    }
+    soundfont_cache::release(sf);
+    sf = NULL;
     if (synth) {
-        delete_fluid_synth(synth);
+        delete_synth(synth);
         synth = NULL;
     }
     if (settings) {
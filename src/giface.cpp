@@ -25,6 +25,7 @@
 #include <calf/giface.h>
 #include <calf/utils.h>
 #include <string.h>
+#include <list>
 
 #ifdef _MSC_VER 
 #define strncasecmp _strnicmp
@@ -154,6 +155,120 @@ double parameter_properties::to_01(float value) const
     }
 }
 
+void parameter_mapping::init(const parameter_properties &props)
+{
+    scale = props.flags & PF_SCALEMASK;
+    switch(props.flags & PF_TYPEMASK)
+    {
+    case PF_INT:
+    case PF_BOOL:
+    case PF_ENUM:
+    case PF_ENUM_MULTI:
+        integer = true;
+        break;
+    default:
+        integer = false;
+        break;
+    }
+    min = props.min;
+    max = props.max;
+    base = min;
+    finite_part = 1.0;
+    switch(scale)
+    {
+    case PF_SCALE_DEFAULT:
+    case PF_SCALE_LINEAR:
+    case PF_SCALE_PERC:
+    case PF_SCALE_QUAD:
+    default:
+        range = double(max) - min;
+        break;
+    case PF_SCALE_LOG_INF:
+        assert(props.step);
+        finite_part = (props.step - 1.0) / props.step;
+        // fall through
+    case PF_SCALE_LOG:
+        range = log(double(max / min));
+        break;
+    case PF_SCALE_GAIN:
+        base = std::max(1.0f / 1024.0f, min);
+        range = log(max / base);
+        break;
+    }
+    inv_range = 1.0 / range;
+    inv_finite_part = 1.0 / finite_part;
+}
+
+float parameter_mapping::from_01(double value01) const
+{
+    double value;
+    switch(scale)
+    {
+    case PF_SCALE_DEFAULT:
+    case PF_SCALE_LINEAR:
+    case PF_SCALE_PERC:
+    default:
+        value = base + range * value01;
+        break;
+    case PF_SCALE_QUAD:
+        value = base + range * value01 * value01;
+        break;
+    case PF_SCALE_LOG:
+        value = base * exp(range * value01);
+        break;
+    case PF_SCALE_GAIN:
+        if (value01 < 0.00001)
+            value = min;
+        else
+            value = base * exp(range * value01);
+        break;
+    case PF_SCALE_LOG_INF:
+        if (value01 > finite_part)
+            value = FAKE_INFINITY;
+        else
+            value = base * exp(range * value01 * inv_finite_part);
+        break;
+    }
+    if (integer)
+    {
+        if (value > 0)
+            value = (int)(value + 0.5);
+        else
+            value = (int)(value - 0.5);
+    }
+    return value;
+}
+
+double parameter_mapping::to_01(float value) const
+{
+    switch(scale)
+    {
+    case PF_SCALE_DEFAULT:
+    case PF_SCALE_LINEAR:
+    case PF_SCALE_PERC:
+    default:
+        return double(value - min) * inv_range;
+    case PF_SCALE_QUAD:
+        return sqrt(double(value - min) * inv_range);
+    case PF_SCALE_LOG:
+        return log(double(value / min)) * inv_range;
+    case PF_SCALE_LOG_INF:
+        if (IS_FAKE_INFINITY(value))
+            return max;
+        return finite_part * log(double(value / min)) * inv_range;
+    case PF_SCALE_GAIN:
+        if (value < 1.0 / 1024.0) // new bottom limit - 60 dB
+            return 0;
+        return log(value / base) * inv_range;
+    }
+}
+
+void parameter_mapping::fill_cc_table(float *values, double min01, double max01) const
+{
+    for (int v = 0; v < 128; v++)
+        values[v] = from_01(min01 + v * (max01 - min01) / 127.0);
+}
+
 float parameter_properties::get_increment() const
 {
     float increment = 0.01;
@@ -431,6 +546,84 @@ void calf_plugins::draw_cairo_label(cairo_iface *context, const char *label, flo
 }
 ////////////////////////////////////////////////////////////////////////
 
+void freq_response_grid::init(int _points, float _srate)
+{
+    points = _points;
+    srate = _srate;
+    freq.resize(points);
+    for (int i = 0; i < points; i++)
+        freq[i] = 20.0 * pow (20000.0 / 20.0, i * 1.0 / points);
+    if (srate <= 0)
+        return;
+    cw.resize(points);
+    sw.resize(points);
+    cw2.resize(points);
+    sw2.resize(points);
+    for (int i = 0; i < points; i++)
+    {
+        double w = freq[i] * 2.0 * M_PI / srate;
+        cw[i] = cos(w);
+        sw[i] = sin(w);
+        cw2[i] = cos(2 * w);
+        sw2[i] = sin(2 * w);
+    }
+}
+
+const freq_response_grid &freq_response_grid::get(int points, float srate)
+{
+    // there are only a few distinct graph sizes and sample rates in a session,
+    // and list elements never move, so the references stay valid
+    static ptmutex mutex;
+    static std::list<freq_response_grid> grids;
+    ptlock lock(mutex);
+    for (std::list<freq_response_grid>::const_iterator i = grids.begin(); i != grids.end(); ++i)
+    {
+        if (i->points == points && i->srate == srate)
+            return *i;
+    }
+    grids.push_back(freq_response_grid());
+    grids.back().init(points, srate);
+    return grids.back();
+}
+
+const float *biquad_response_cache::get()
+{
+    assert(grid && grid->srate > 0);
+    int points = grid->points;
+    if (grid == old_grid && stages == old_stages && (int)gains.size() == points)
+        return &gains[0];
+    
+    // H(z) = (a0 + a1 z^-1 + a2 z^-2) / (1 + b1 z^-1 + b2 z^-2), z^-n = cos(nw) - j sin(nw)
+    std::vector<double> acc(points, 1.0);
+    const double *cw = &grid->cw[0], *sw = &grid->sw[0], *cw2 = &grid->cw2[0], *sw2 = &grid->sw2[0];
+    for (size_t st = 0; st < stages.size(); st += 6)
+    {
+        double a0 = stages[st], a1 = stages[st + 1], a2 = stages[st + 2];
+        double b1 = stages[st + 3], b2 = stages[st + 4];
+        int times = (int)stages[st + 5];
+        double *out = &acc[0];
+        for (int i = 0; i < points; i++)
+        {
+            double nre = a0 + a1 * cw[i] + a2 * cw2[i];
+            double nim = a1 * sw[i] + a2 * sw2[i];
+            double dre = 1.0 + b1 * cw[i] + b2 * cw2[i];
+            double dim = b1 * sw[i] + b2 * sw2[i];
+            double g = sqrt((nre * nre + nim * nim) / (dre * dre + dim * dim));
+            double gt = g;
+            for (int t = 1; t < times; t++)
+                gt *= g;
+            out[i] *= gt;
+        }
+    }
+    gains.resize(points);
+    for (int i = 0; i < points; i++)
+        gains[i] = acc[i];
+    old_grid = grid;
+    old_stages.swap(stages);
+    stages.clear();
+    return &gains[0];
+}
+
 bool frequency_response_line_graph::get_graph(int index, int subindex, int phase, float *data, int points, cairo_iface *context, int *mode) const
 {
     if (phase || subindex)
@@ -29,6 +29,7 @@ gtk_main_window::gtk_main_window()
     owner = NULL;
     notifier = NULL;
     is_closed = true;
+    scheduled = false;
     progress_window = NULL;
     images = image_factory();
 }
@@ -479,6 +480,12 @@ plugin_strip *gtk_main_window::create_strip(jack_host *plugin)
     GtkWidget *buttonBox = gtk_hbox_new(FALSE, 5);
     gtk_box_pack_start(GTK_BOX(buttonBox), GTK_WIDGET(strip->button), FALSE, FALSE, 0);
     gtk_box_pack_start(GTK_BOX(buttonBox), GTK_WIDGET(strip->con), FALSE, FALSE, 0);
+    
+    // DSP load, filled in by on_frame
+    strip->load = gtk_label_new("");
+    gtk_widget_set_name(GTK_WIDGET(strip->load), "Calf-Rack-Load");
+    gtk_widget_set_tooltip_text(strip->load, "DSP load over the last second (mean / 99th percentile / maximum), as a percentage of the JACK period");
+    gtk_box_pack_start(GTK_BOX(buttonBox), GTK_WIDGET(strip->load), FALSE, FALSE, 0);
     gtk_container_add(GTK_CONTAINER(balign), buttonBox);
     gtk_table_attach(GTK_TABLE(strip->strip_table), balign, 1, 3, 2, 3, ao, ao, 5, 5);
     gtk_widget_show_all(balign);
@@ -902,10 +909,10 @@ void gtk_main_window::create()
     gtk_widget_show(GTK_WIDGET(all_vbox));
     gtk_widget_show(GTK_WIDGET(toplevel));
     
-    source_id = g_timeout_add_full(G_PRIORITY_DEFAULT, 1000/30, on_idle, this, NULL); // 30 fps should be enough for everybody
-    
     notifier = get_config_db()->add_listener(this);
     on_config_change();
+    gui_refresh_scheduler::get().add_client(this);
+    scheduled = true;
     g_signal_connect(GTK_OBJECT(toplevel), "destroy", G_CALLBACK(window_destroy_cb), this);
     g_signal_connect(GTK_OBJECT(toplevel), "delete_event", G_CALLBACK(window_delete_cb), this);
     
@@ -938,6 +945,8 @@ void gtk_main_window::on_config_change()
     show_rack_ears(get_config()->rack_ears);    
     show_vu_meters(get_config()->vu_meters);
     sort_strips();
+    gui_refresh_scheduler::get().set_frame_rate(get_config()->refresh_rate);
+    gui_refresh_scheduler::get().set_frame_budget(get_config()->frame_budget);
 }
 
 void gtk_main_window::refresh_plugin(plugin_ctl_iface *plugin)
@@ -969,8 +978,9 @@ void gtk_main_window::on_closed()
         delete notifier;
         notifier = NULL;
     }
-    if (source_id)
-        g_source_remove(source_id);
+    if (scheduled)
+        gui_refresh_scheduler::get().remove_client(this);
+    scheduled = false;
     is_closed = true;
     toplevel = NULL;
 
@@ -988,16 +998,18 @@ static inline float LVL(float value)
     return value; //sqrt(value) * 0.75;
 }
 
-gboolean gtk_main_window::on_idle(void *data)
+void gtk_main_window::on_tick()
 {
-    gtk_main_window *self = (gtk_main_window *)data;
+    owner->on_idle();
+}
 
-    self->owner->on_idle();
-    
-    if (!self->refresh_controller.check_redraw(GTK_WIDGET(self->toplevel)))
-        return TRUE;
+bool gtk_main_window::on_frame()
+{
+    if (!toplevel || !gui_refresh_scheduler::is_visible(GTK_WIDGET(toplevel)))
+        return false;
 
-    for (std::map<plugin_ctl_iface *, plugin_strip *>::iterator i = self->plugins.begin(); i != self->plugins.end(); ++i)
+    bool active = false;
+    for (std::map<plugin_ctl_iface *, plugin_strip *>::iterator i = plugins.begin(); i != plugins.end(); ++i)
     {
         if (i->second)
         {
@@ -1006,14 +1018,18 @@ gboolean gtk_main_window::on_idle(void *data)
             int idx = 0;
             if (strip->inBox && gtk_widget_is_drawable (strip->inBox)) {
                 for (int i = 0; i < (int)strip->audio_in.size(); i++) {
-                    calf_vumeter_set_value(CALF_VUMETER(strip->audio_in[i]), LVL(plugin->get_level(idx++)));
+                    float level = LVL(plugin->get_level(idx++));
+                    calf_vumeter_set_value(CALF_VUMETER(strip->audio_in[i]), level);
+                    active = active || level > 0;
                 }
             }
             else
                 idx += strip->audio_in.size();
             if (strip->outBox && gtk_widget_is_drawable (strip->outBox)) {
                 for (int i = 0; i < (int)strip->audio_out.size(); i++) {
-                    calf_vumeter_set_value(CALF_VUMETER(strip->audio_out[i]), LVL(plugin->get_level(idx++)));
+                    float level = LVL(plugin->get_level(idx++));
+                    calf_vumeter_set_value(CALF_VUMETER(strip->audio_out[i]), level);
+                    active = active || level > 0;
                 }
             }
             else
@@ -1021,9 +1037,19 @@ gboolean gtk_main_window::on_idle(void *data)
             if (plugin->get_metadata_iface()->get_midi()) {
                 calf_led_set_value (CALF_LED (strip->midi_in), plugin->get_level(idx++));
             }
+            // the statistics only change once a second
+            dsp_load_meter::stats last, overall;
+            uint32_t serial = strip->plugin->load_meter.get(last, overall);
+            if (serial != strip->load_serial) {
+                strip->load_serial = serial;
+                char buf[64];
+                snprintf(buf, sizeof(buf), "DSP %.1f / %.1f / %.1f %%", last.mean * 100, last.p99 * 100, last.max * 100);
+                gtk_label_set_text(GTK_LABEL(strip->load), buf);
+                active = true;
+            }
         }
     }
-    return TRUE;
+    return active;
 }
 
 void gtk_main_window::open_file()
@@ -210,6 +210,8 @@ GtkWidget *plugin_gui::create_from_xml(plugin_ctl_iface *_plugin, const char *xm
     read_serials.clear();
     int size = plugin->get_metadata_iface()->get_param_count();
     read_serials.resize(size);
+    output_values.clear();
+    output_values.resize(size, -1.f);
     for (int i = 0; i < size; i++)
         param_name_map[plugin->get_metadata_iface()->get_param_props(i)->short_name] = i;
     
@@ -278,7 +280,7 @@ void plugin_gui::remove_param_ctl(int param, param_control *ctl)
     }
 }
 
-void plugin_gui::on_idle()
+bool plugin_gui::on_idle()
 {
     set<unsigned> changed;
     for (unsigned i = 0; i < read_serials.size(); i++)
@@ -290,6 +292,7 @@ void plugin_gui::on_idle()
             changed.insert(i);
         }
     }
+    bool any_change = !changed.empty();
     for (unsigned i = 0; i < params.size(); i++)
     {
         int param_no = params[i]->param_no;
@@ -297,13 +300,24 @@ void plugin_gui::on_idle()
         {
             const parameter_properties &props = *plugin->get_metadata_iface()->get_param_props(param_no);
             bool is_output = (props.flags & PF_PROP_OUTPUT) != 0;
+            if (is_output) {
+                // set anyway, meters animate their falloff and hold on their own
+                float value = plugin->get_param_value(param_no);
+                if (value != output_values[param_no]) {
+                    output_values[param_no] = value;
+                    any_change = true;
+                }
+            }
             if (is_output || (param_no != -1 && changed.count(param_no)))
                 params[i]->set();
         }
         params[i]->on_idle();
     }    
-    last_status_serial_no = plugin->send_status_updates(this, last_status_serial_no);
+    int serial = plugin->send_status_updates(this, last_status_serial_no);
+    any_change = any_change || serial != last_status_serial_no;
+    last_status_serial_no = serial;
     // XXXKF iterate over par2ctl, too...
+    return any_change;
 }
 
 void plugin_gui::refresh()
@@ -477,24 +491,159 @@ plugin_gui::~plugin_gui()
     delete preset_access;
 }
 
-/***************************** GUI environment ********************************************/
+/***************************** GUI refresh scheduler **************************************/
 
-bool window_update_controller::check_redraw(GtkWidget *toplevel)
+gui_refresh_scheduler::gui_refresh_scheduler()
 {
-    GdkWindow *gdkwin = gtk_widget_get_window(toplevel);
-    if (!gdkwin)
-        return false;
+    next_client = 0;
+    in_frame = false;
+    source_id = 0;
+    frame_rate = 30; // 30 fps should be enough for everybody
+    frame_budget = 15;
+}
+
+gui_refresh_scheduler &gui_refresh_scheduler::get()
+{
+    static gui_refresh_scheduler instance;
+    return instance;
+}
+
+void gui_refresh_scheduler::add_client(client_iface *client)
+{
+    client_data cd;
+    cd.client = client;
+    cd.static_frames = 0;
+    cd.wait = 0;
+    clients.push_back(cd);
+    if (!source_id)
+        restart();
+}
+
+void gui_refresh_scheduler::remove_client(client_iface *client)
+{
+    for (unsigned int i = 0; i < clients.size(); i++)
+    {
+        if (clients[i].client != client)
+            continue;
+        // don't shuffle the list while on_frame iterates over it, the
+        // empty slot is removed at the end of the frame
+        if (in_frame)
+            clients[i].client = NULL;
+        else
+        {
+            clients.erase(clients.begin() + i);
+            if (next_client > i)
+                next_client--;
+        }
+        break;
+    }
+    if (clients.empty() && source_id)
+    {
+        g_source_remove(source_id);
+        source_id = 0;
+    }
+}
+
+void gui_refresh_scheduler::set_frame_rate(int fps)
+{
+    fps = std::max(1, std::min(100, fps));
+    if (fps == frame_rate)
+        return;
+    frame_rate = fps;
+    if (source_id)
+        restart();
+}
+
+void gui_refresh_scheduler::set_frame_budget(int ms)
+{
+    frame_budget = std::max(1, ms);
+}
 
-    if (!gdk_window_is_viewable(gdkwin))
+void gui_refresh_scheduler::restart()
+{
+    if (source_id)
+        g_source_remove(source_id);
+    // low priority, so that redrawing the widgets updated in the
+    // previous frame goes first
+    source_id = g_timeout_add_full(G_PRIORITY_LOW, 1000 / frame_rate, on_timer, this, NULL);
+}
+
+gboolean gui_refresh_scheduler::on_timer(void *data)
+{
+    gui_refresh_scheduler *self = (gui_refresh_scheduler *)data;
+    guint id = self->source_id;
+    self->on_frame();
+    // the source may have been removed (no clients left) or replaced
+    // (frame rate changed) in the meantime
+    return self->source_id == id;
+}
+
+bool gui_refresh_scheduler::is_visible(GtkWidget *widget)
+{
+    if (!GTK_WIDGET_DRAWABLE(widget))
+        return false;
+    GdkWindow *gdkwin = gtk_widget_get_window(gtk_widget_get_toplevel(widget));
+    if (!gdkwin || !gdk_window_is_viewable(gdkwin))
         return false;
-    GdkWindowState state = gdk_window_get_state(gdkwin);
-    if (state & GDK_WINDOW_STATE_ICONIFIED)
+    return !(gdk_window_get_state(gdkwin) & GDK_WINDOW_STATE_ICONIFIED);
+}
+
+void gui_refresh_scheduler::on_frame()
+{
+    in_frame = true;
+    for (unsigned int i = 0; i < clients.size(); i++)
     {
-        ++refresh_counter;
-        if (refresh_counter & 15)
-            return false;
+        if (clients[i].client)
+            clients[i].client->on_tick();
+    }
+    gint64 deadline = g_get_monotonic_time() + frame_budget * 1000;
+    for (unsigned int n = clients.size(); n > 0; n--)
+    {
+        if (next_client >= clients.size())
+            next_client = 0;
+        unsigned int i = next_client++;
+        if (!clients[i].client)
+            continue;
+        if (clients[i].wait > 0)
+        {
+            clients[i].wait--;
+            continue;
+        }
+        GtkWidget *widget = clients[i].client->get_frame_widget();
+        if (widget && !is_visible(widget))
+            continue;
+        bool changed = clients[i].client->on_frame();
+        // the client may have removed itself in the meantime
+        if (!clients[i].client)
+            continue;
+        client_data &cd = clients[i];
+        cd.static_frames = changed ? 0 : cd.static_frames + 1;
+        // back off to 1/2 and then 1/4 of the frame rate when the
+        // content stays the same for more than 0.5 s and 2 s
+        if (cd.static_frames > 2 * frame_rate)
+            cd.wait = 3;
+        else if (cd.static_frames > frame_rate / 2)
+            cd.wait = 1;
+        if (g_get_monotonic_time() > deadline)
+            break;
+    }
+    in_frame = false;
+    for (unsigned int i = 0; i < clients.size(); )
+    {
+        if (clients[i].client)
+            i++;
+        else
+        {
+            clients.erase(clients.begin() + i);
+            if (next_client > i)
+                next_client--;
+        }
+    }
+    if (clients.empty() && source_id)
+    {
+        g_source_remove(source_id);
+        source_id = 0;
     }
-    return true;
 }
 
 /***************************** GUI environment ********************************************/
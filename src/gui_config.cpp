@@ -13,6 +13,8 @@ gui_config::gui_config()
     vu_meters        = true;
     win_to_tray      = false;
     win_start_hidden = false;
+    refresh_rate     = 30;
+    frame_budget     = 15;
     style       = "Calf_Default";
 }
 
@@ -29,6 +31,8 @@ void gui_config::load(config_db_iface *db)
     style            = db->get_string("style", gui_config().style);
     win_to_tray      = db->get_bool("win-to-tray", gui_config().win_to_tray);
     win_start_hidden = db->get_bool("win-start-hidden", gui_config().win_start_hidden);
+    refresh_rate     = db->get_int("gui-refresh-rate", gui_config().refresh_rate);
+    frame_budget     = db->get_int("gui-frame-budget", gui_config().frame_budget);
 }
 
 void gui_config::save(config_db_iface *db)
@@ -40,6 +44,8 @@ void gui_config::save(config_db_iface *db)
     db->set_string("style", style);
     db->set_bool("win-to-tray", win_to_tray);
     db->set_bool("win-start-hidden", win_start_hidden);
+    db->set_int("gui-refresh-rate", refresh_rate);
+    db->set_int("gui-frame-budget", frame_budget);
     db->save();
 }
 
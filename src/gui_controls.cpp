@@ -471,15 +471,13 @@ GtkWidget *hscale_param_control::create(plugin_gui *_gui, int _param_no)
 void hscale_param_control::set()
 {
     _GUARD_CHANGE_
-    const parameter_properties &props = get_props();
-    gtk_range_set_value (GTK_RANGE (widget), props.to_01 (gui->plugin->get_param_value(param_no)));
+    gtk_range_set_value (GTK_RANGE (widget), get_mapping().to_01 (gui->plugin->get_param_value(param_no)));
     // hscale_value_changed (GTK_HSCALE (widget), (gpointer)this);
 }
 
 void hscale_param_control::get()
 {
-    const parameter_properties &props = get_props();
-    float cvalue = props.from_01 (gtk_range_get_value (GTK_RANGE (widget)));
+    float cvalue = get_mapping().from_01 (gtk_range_get_value (GTK_RANGE (widget)));
     gui->set_param_value(param_no, cvalue, this);
 }
 
@@ -493,7 +491,7 @@ gchar *hscale_param_control::hscale_format_value(GtkScale *widget, double arg1,
 {
     hscale_param_control *jhp = (hscale_param_control *)value;
     const parameter_properties &props = jhp->get_props();
-    float cvalue = props.from_01 (arg1);
+    float cvalue = jhp->get_mapping().from_01 (arg1);
     
     // for testing
     // return g_strdup_printf ("%s = %g", props.to_string (cvalue).c_str(), arg1);
@@ -537,15 +535,13 @@ GtkWidget *vscale_param_control::create(plugin_gui *_gui, int _param_no)
 void vscale_param_control::set()
 {
     _GUARD_CHANGE_
-    const parameter_properties &props = get_props();
-    gtk_range_set_value (GTK_RANGE (widget), props.to_01 (gui->plugin->get_param_value(param_no)));
+    gtk_range_set_value (GTK_RANGE (widget), get_mapping().to_01 (gui->plugin->get_param_value(param_no)));
     // vscale_value_changed (GTK_HSCALE (widget), (gpointer)this);
 }
 
 void vscale_param_control::get()
 {
-    const parameter_properties &props = get_props();
-    float cvalue = props.from_01 (gtk_range_get_value (GTK_RANGE (widget)));
+    float cvalue = get_mapping().from_01 (gtk_range_get_value (GTK_RANGE (widget)));
     gui->set_param_value(param_no, cvalue, this);
 }
 
@@ -899,16 +895,14 @@ GtkWidget *knob_param_control::create(plugin_gui *_gui, int _param_no)
 
 void knob_param_control::get()
 {
-    const parameter_properties &props = get_props();
-    float value = props.from_01(gtk_range_get_value(GTK_RANGE(widget)));
+    float value = get_mapping().from_01(gtk_range_get_value(GTK_RANGE(widget)));
     gui->set_param_value(param_no, value, this);
 }
 
 void knob_param_control::set()
 {
     _GUARD_CHANGE_
-    const parameter_properties &props = get_props();
-    gtk_range_set_value(GTK_RANGE(widget), props.to_01 (gui->plugin->get_param_value(param_no)));
+    gtk_range_set_value(GTK_RANGE(widget), get_mapping().to_01 (gui->plugin->get_param_value(param_no)));
 }
 
 void knob_param_control::knob_value_changed(GtkWidget *widget, gpointer value)
@@ -945,17 +939,15 @@ GtkWidget *toggle_param_control::create(plugin_gui *_gui, int _param_no)
 
 void toggle_param_control::get()
 {
-    const parameter_properties &props = get_props();
-    float value = props.from_01(gtk_range_get_value(GTK_RANGE(widget)));
+    float value = get_mapping().from_01(gtk_range_get_value(GTK_RANGE(widget)));
     gui->set_param_value(param_no, value, this);
 }
 
 void toggle_param_control::set()
 {
     _GUARD_CHANGE_
-    const parameter_properties &props = get_props();
     float value = gui->plugin->get_param_value(param_no);
-    gtk_range_set_value(GTK_RANGE(widget), props.to_01(value));
+    gtk_range_set_value(GTK_RANGE(widget), get_mapping().to_01(value));
 }
 
 void toggle_param_control::toggle_value_changed(GtkWidget *widget, gpointer value)
@@ -1379,8 +1371,8 @@ void line_graph_param_control::get()
             FreqHandle *handle = &clg->freq_handles[clg->handle_hovered];
 
             if(handle->param_z_no > -1) {
-                const parameter_properties &handle_z_props = *gui->plugin->get_metadata_iface()->get_param_props(handle->param_z_no);
-                float value_z = handle_z_props.from_01(handle->value_z);
+                const parameter_mapping &handle_z_mapping = *gui->plugin->get_metadata_iface()->get_param_mapping(handle->param_z_no);
+                float value_z = handle_z_mapping.from_01(handle->value_z);
                 gui->set_param_value(handle->param_z_no, value_z, this);
             }
         }
@@ -1439,9 +1431,9 @@ void line_graph_param_control::set()
             }
 
             if(handle->param_z_no >= 0) {
-                const parameter_properties &handle_z_props = *gui->plugin->get_metadata_iface()->get_param_props(handle->param_z_no);
+                const parameter_mapping &handle_z_mapping = *gui->plugin->get_metadata_iface()->get_param_mapping(handle->param_z_no);
                 float value_z = gui->plugin->get_param_value(handle->param_z_no);
-                handle->value_z = handle_z_props.to_01(value_z);
+                handle->value_z = handle_z_mapping.to_01(value_z);
                 if (dsp::_sanitize(handle->value_z - handle->last_value_z)) {
                     clg->handle_redraw = 1;
                 }
@@ -373,11 +373,34 @@ void host_session::close()
     }
         
     client.deactivate();
+    if (!load_report_name.empty())
+        write_load_report();
     client.delete_plugins();
     client.destroy_automation_input();
     client.close();
 }
 
+void host_session::write_load_report()
+{
+    FILE *f = load_report_name == "-" ? stdout : fopen(load_report_name.c_str(), "w");
+    if (!f)
+    {
+        fprintf(stderr, "Cannot write DSP load report to %s: %s\n", load_report_name.c_str(), strerror(errno));
+        return;
+    }
+    fprintf(f, "# DSP load in %% of the JACK period - whole run, then the last second\n");
+    fprintf(f, "# %-22s %10s %7s %7s %7s %7s %7s %7s\n", "instance", "cycles", "mean", "p99", "max", "mean", "p99", "max");
+    for (unsigned int i = 0; i < plugins.size(); i++)
+    {
+        dsp_load_meter::stats last, overall;
+        plugins[i]->load_meter.get(last, overall);
+        fprintf(f, "%-24s %10u %7.2f %7.2f %7.2f %7.2f %7.2f %7.2f\n", plugins[i]->instance_name.c_str(), overall.cycles,
+            overall.mean * 100, overall.p99 * 100, overall.max * 100, last.mean * 100, last.p99 * 100, last.max * 100);
+    }
+    if (f != stdout)
+        fclose(f);
+}
+
 static string stripfmt(string x)
 {
     if (x.length() < 2)
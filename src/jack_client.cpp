@@ -25,6 +25,7 @@
 #include <calf/giface.h>
 #include <calf/jackhost.h>
 #include <set>
+#include <unistd.h>
 
 using namespace std;
 using namespace calf_utils;
@@ -39,12 +40,45 @@ jack_client::jack_client()
     sample_rate = 0;
     client = NULL;
     automation_port = NULL;
+    // way more than any controller surface can send in one period
+    automation_events.resize(1024);
+    automation_event_count = 0;
+    rt_plugins = new std::vector<jack_host *>;
+    rt_epoch = 0;
+}
+
+jack_client::~jack_client()
+{
+    delete rt_plugins;
+}
+
+void jack_client::publish_plugins()
+{
+    std::vector<jack_host *> *old_plugins = __sync_lock_test_and_set(&rt_plugins, new std::vector<jack_host *>(plugins));
+    // this also keeps the removed plugins alive until they're guaranteed
+    // not to be processed anymore
+    wait_for_cycle();
+    delete old_plugins;
+}
+
+void jack_client::wait_for_cycle()
+{
+    __sync_synchronize();
+    // Cycles starting after this point see whatever was stored before it,
+    // so only a cycle that is running right now may be using old data.
+    int epoch = rt_epoch;
+    if (epoch & 1)
+    {
+        while(rt_epoch == epoch)
+            usleep(1000);
+    }
 }
 
 void jack_client::add(jack_host *plugin)
 {
     calf_utils::ptlock lock(mutex);
     plugins.push_back(plugin);
+    publish_plugins();
 }
 
 void jack_client::del(jack_host *plugin)
@@ -55,6 +89,7 @@ void jack_client::del(jack_host *plugin)
         if (plugins[i] == plugin)
         {
             plugins.erase(plugins.begin()+i);
+            publish_plugins();
             return;
         }
     }
@@ -111,37 +146,27 @@ namespace {
 
 class jack_automation: public automation_iface
 {
-    int event_pos;
-    int event_count;
+    unsigned int event_pos;
+    unsigned int event_count;
+    const automation_event *events;
     jack_host *plugin;
-    void *midi_data;
-    jack_midi_event_t event;
-    
-    void process_event()
-    {
-        if (event.size == 3 && ((event.buffer[0] & 0xF0) == 0xB0))
-        {
-            int designator = ((event.buffer[0] & 0xF) << 8) | event.buffer[1];
-            plugin->handle_automation_cc(designator, event.buffer[2]);
-        }
-    }
 public:
-    jack_automation(jack_port_t *automation_port, int nframes, jack_host *_plugin)
+    jack_automation(const automation_event *_events, unsigned int _event_count, jack_host *_plugin)
     {
         event_pos = 0;
+        event_count = _event_count;
+        events = _events;
         plugin = _plugin;
-        midi_data = jack_port_get_buffer(automation_port, nframes);
-        event_count = jack_midi_get_event_count(midi_data NFRAMES_MAYBE(nframes));
     }
     
     uint32_t apply_and_adjust(uint32_t start, uint32_t time)
     {
         while(event_pos < event_count) {
-            jack_midi_event_get(&event, midi_data, event_pos NFRAMES_MAYBE(nframes));
+            const automation_event &event = events[event_pos];
             if (event.time > start && event.time < time)
                 return event.time;
             event_pos++;
-            process_event();
+            plugin->handle_automation_cc(event.designator, event.value);
         }
         return time;
     }
@@ -149,18 +174,41 @@ public:
 
 }
 
+void jack_client::decode_automation(jack_nframes_t nframes)
+{
+    automation_event_count = 0;
+    if (!automation_port)
+        return;
+    void *midi_data = jack_port_get_buffer(automation_port, nframes);
+    int count = jack_midi_get_event_count(midi_data NFRAMES_MAYBE(nframes));
+    jack_midi_event_t event;
+    for (int i = 0; i < count && automation_event_count < automation_events.size(); i++)
+    {
+        jack_midi_event_get(&event, midi_data, i NFRAMES_MAYBE(nframes));
+        // only controller changes are used for automation
+        if (event.size != 3 || (event.buffer[0] & 0xF0) != 0xB0)
+            continue;
+        automation_event &ae = automation_events[automation_event_count++];
+        ae.time = event.time;
+        ae.designator = ((event.buffer[0] & 0xF) << 8) | event.buffer[1];
+        ae.value = event.buffer[2];
+    }
+}
+
 int jack_client::do_jack_process(jack_nframes_t nframes, void *p)
 {
     jack_client *self = (jack_client *)p;
-    pttrylock lock(self->mutex);
-    if (lock.is_locked())
+    // never blocks - the list is only swapped by publish_plugins, which
+    // then waits for the epoch to change before freeing the old one
+    __sync_add_and_fetch(&self->rt_epoch, 1);
+    const std::vector<jack_host *> &plugins = *self->rt_plugins;
+    self->decode_automation(nframes);
+    for(unsigned int i = 0; i < plugins.size(); i++)
     {
-        for(unsigned int i = 0; i < self->plugins.size(); i++)
-        {
-            jack_automation au(self->automation_port, nframes, self->plugins[i]);
-            self->plugins[i]->process(nframes, au);
-        }
+        jack_automation au(&self->automation_events[0], self->automation_event_count, plugins[i]);
+        plugins[i]->process(nframes, au);
     }
+    __sync_add_and_fetch(&self->rt_epoch, 1);
     return 0;
 }
 
@@ -176,10 +224,12 @@ int jack_client::do_jack_bufsize(jack_nframes_t numsamples, void *p)
 void jack_client::delete_plugins()
 {
     ptlock lock(mutex);
-    for (unsigned int i = 0; i < plugins.size(); i++) {
-        delete plugins[i];
+    std::vector<jack_host *> old_plugins;
+    old_plugins.swap(plugins);
+    publish_plugins();
+    for (unsigned int i = 0; i < old_plugins.size(); i++) {
+        delete old_plugins[i];
     }
-    plugins.clear();
 }
 
 void jack_client::create_automation_input()
@@ -269,10 +319,11 @@ void jack_client::apply_plugin_order(const std::vector<int> &indices)
 {
     std::vector<jack_host *> plugins_new;
     assert(indices.size() == plugins.size());
+    ptlock lock(mutex);
     for (unsigned int i = 0; i < indices.size(); i++)
         plugins_new.push_back(plugins[indices[i]]);
-    ptlock lock(mutex);
     plugins.swap(plugins_new);
+    publish_plugins();
     
     string s;
     for (unsigned int i = 0; i < plugins.size(); i++)    
@@ -283,3 +334,58 @@ void jack_client::apply_plugin_order(const std::vector<int> &indices)
     }
     printf("Order: %s\n", s.c_str());
 }
+
+void dsp_load_meter::reset()
+{
+    window.reset();
+    total.reset();
+    window_frames = 0;
+    serial = 0;
+    memset(&last, 0, sizeof(last));
+    memset(&overall, 0, sizeof(overall));
+}
+
+void dsp_load_meter::accumulator::get(stats &s) const
+{
+    s.cycles = cycles;
+    s.mean = cycles ? sum / cycles : 0;
+    s.max = max;
+    // upper edge of the bin the 99th percentile falls into
+    uint32_t limit = cycles - cycles / 100, count = 0;
+    int bin = 0;
+    while (bin < hist_bins - 1 && (count += hist[bin]) < limit)
+        bin++;
+    s.p99 = std::min<double>((bin + 1) * 0.01, max);
+}
+
+void dsp_load_meter::add_cycle(double seconds, uint32_t nframes, uint32_t sample_rate)
+{
+    if (!nframes)
+        return;
+    double load = seconds * sample_rate / nframes;
+    window.add(load);
+    total.add(load);
+    window_frames += nframes;
+    if (window_frames < sample_rate)
+        return;
+    // seqlock style: readers retry if the serial was odd or has changed
+    __sync_add_and_fetch(&serial, 1);
+    window.get(last);
+    total.get(overall);
+    __sync_add_and_fetch(&serial, 1);
+    window.reset();
+    window_frames = 0;
+}
+
+uint32_t dsp_load_meter::get(stats &s_last, stats &s_overall) const
+{
+    uint32_t s;
+    do {
+        s = serial;
+        __sync_synchronize();
+        s_last = last;
+        s_overall = overall;
+        __sync_synchronize();
+    } while ((s & 1) || s != serial);
+    return s;
+}
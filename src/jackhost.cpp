@@ -51,6 +51,7 @@ jack_host::jack_host(jack_client *_client, audio_module_iface *_module, const st
     
     client = _client;
     cc_mappings = NULL;
+    cc_dispatch = NULL;
     changed = true;
 
     module->get_port_arrays(ins, outs, params);
@@ -78,6 +79,8 @@ jack_host::~jack_host()
 {
     delete cc_mappings;
     cc_mappings = NULL;
+    delete cc_dispatch;
+    cc_dispatch = NULL;
     delete []param_values;
     if (client)
         destroy();
@@ -173,16 +176,15 @@ void jack_host::rename(std::string name) {
 void jack_host::handle_automation_cc(uint32_t designator, int value)
 {
     last_designator = designator;
-    if (!cc_mappings)
+    const automation_dispatch *dispatch = cc_dispatch;
+    int slot = automation_dispatch::slot(designator);
+    if (!dispatch || slot < 0)
         return;
-    automation_map::const_iterator i = cc_mappings->find(designator);
-    while (i != cc_mappings->end() && i->first == designator)
+    for (unsigned int i = dispatch->first[slot]; i < dispatch->first[slot + 1]; i++)
     {
-        const automation_range &r = i->second;
-        const parameter_properties *props = metadata->get_param_props(r.param_no);
-        set_param_value(r.param_no, props->from_01(r.min_value + value * (r.max_value - r.min_value)/ 127.0));
-        write_serials[r.param_no] = ++last_modify_serial;
-        ++i;
+        const automation_dispatch::target &t = dispatch->targets[i];
+        set_param_value(t.param_no, t.values[value & 127]);
+        write_serials[t.param_no] = ++last_modify_serial;
     }
 }
 
@@ -277,6 +279,7 @@ float jack_host::get_level(unsigned int port)
 
 int jack_host::process(jack_nframes_t nframes, automation_iface &automation)
 {
+    double start_time = dsp_load_meter::now();
     for (int i=0; i<in_count; i++) {
         ins[i] = inputs[i].data = (float *)jack_port_get_buffer(inputs[i].handle, nframes);
     }
@@ -312,6 +315,7 @@ int jack_host::process(jack_nframes_t nframes, automation_iface &automation)
         time = endtime;
     }
     module->params_reset();
+    load_meter.add_cycle(dsp_load_meter::now() - start_time, nframes, client->sample_rate);
     return 0;
 }
 
@@ -343,6 +347,28 @@ void jack_host::get_all_output_ports(std::vector<port *> &ports)
         ports.push_back(&outputs[i]);
 }
 
+automation_dispatch::automation_dispatch(const automation_map &amap, const plugin_metadata_iface *metadata)
+{
+    // the map is sorted by designator, and so the valid designators come
+    // in slot order
+    int s = 0;
+    for (automation_map::const_iterator i = amap.begin(); i != amap.end(); ++i)
+    {
+        int slot_no = slot(i->first);
+        if (slot_no < 0)
+            continue;
+        while (s <= slot_no)
+            first[s++] = targets.size();
+        const automation_range &r = i->second;
+        targets.push_back(target());
+        target &t = targets.back();
+        t.param_no = r.param_no;
+        metadata->get_param_mapping(r.param_no)->fill_cc_table(t.values, r.min_value, r.max_value);
+    }
+    while (s <= slot_count)
+        first[s++] = targets.size();
+}
+
 static void remove_mapping(automation_map &amap, uint32_t source, int param_no)
 {
     for(automation_map::iterator i = amap.find(source); i != amap.end() && i->first == source; )
@@ -376,7 +402,11 @@ void jack_host::delete_automation(uint32_t source, int param_no)
 
 void jack_host::replace_automation_map(automation_map *amap)
 {
-    client->atomic_swap(cc_mappings, amap);
+    // cc_mappings is only used outside the process thread
+    automation_dispatch *dispatch = __sync_lock_test_and_set(&cc_dispatch, new automation_dispatch(*amap, metadata));
+    std::swap(cc_mappings, amap);
+    client->wait_for_cycle();
+    delete dispatch;
     delete amap;
 }
 
@@ -417,7 +447,7 @@ char *jack_host::configure(const char *key, const char *value)
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-static const char *short_options = "c:i:l:o:m:M:s:S:ehvLnt";
+static const char *short_options = "c:i:l:o:m:M:s:S:P:ehvLnt";
 
 static struct option long_options[] = {
     {"help", 0, 0, 'h'},
@@ -434,6 +464,7 @@ static struct option long_options[] = {
     {"list", 0, 0, 'L'},
     {"no-gui", 0, 0, 'n'},
     {"no-tray", 0, 0, 't'},
+    {"dsp-load", 1, 0, 'P'},
     {0,0,0,0},
 };
 
@@ -442,6 +473,7 @@ void print_help(char *argv[])
     printf("JACK host for Calf effects\n"
         "Syntax: %s [--client, -c <name>] [--input, -i <name>] [--output, -o <name>] [--midi, -m <name>] [--load|state, -l|s <session>]\n"
         "       [--connect-midi, -M <name|capture-index>] [--help, -h] [--version, -v] [--list, -L] [--no-tray, -t]\n"
+        "       [--dsp-load, -P <file|->]\n"
         "       [!] pluginname[:<preset>] [!] ...\n", 
         argv[0]);
 }
@@ -520,6 +552,9 @@ int main(int argc, char *argv[])
             case 't':
                 sess.has_trayicon = false;
                 break;
+            case 'P':
+                sess.load_report_name = optarg;
+                break;
             case 'l':
             case 's':
             {
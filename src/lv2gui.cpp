@@ -255,18 +255,18 @@ void plugin_proxy_base::enable_all_sends()
 
 /// Plugin controller that uses LV2 host with help of instance/data access to remotely
 /// control a plugin from the GUI
-struct lv2_plugin_proxy: public plugin_ctl_iface, public plugin_proxy_base, public gui_environment
+struct lv2_plugin_proxy: public plugin_ctl_iface, public plugin_proxy_base, public gui_environment, public gui_refresh_scheduler::client_iface
 {
     /// Plugin GTK+ GUI object pointer
     plugin_gui *gui;
-    /// Glib source ID for update timer
-    int source_id;
+    /// Registered with the GUI refresh scheduler
+    bool scheduled;
     
     lv2_plugin_proxy(const plugin_metadata_iface *md, LV2UI_Write_Function wf, LV2UI_Controller c, const LV2_Feature* const* f)
     : plugin_proxy_base(md, wf, c, f)
     {
         gui = NULL;
-        source_id = 0;
+        scheduled = false;
         if (instance)
         {
             conditions.insert("directlink");
@@ -314,19 +314,12 @@ struct lv2_plugin_proxy: public plugin_ctl_iface, public plugin_proxy_base, publ
     
     /// Override for a method in plugin_ctl_iface - trivial delegation to base class
     virtual const phase_graph_iface *get_phase_graph_iface() const { return plugin_proxy_base::get_phase_graph_iface(); }
+    
+    /// Periodic update called by the GUI refresh scheduler
+    virtual bool on_frame() { return gui->optwidget ? gui->on_idle() : false; }
+    virtual GtkWidget *get_frame_widget() { return gui->optwidget; }
 };
 
-static gboolean plugin_on_idle(void *data)
-{
-    plugin_gui *self = (plugin_gui *)data;
-    if (self->optwidget) {
-        self->on_idle();
-        return TRUE;
-    } else {
-        return FALSE;
-    }
-}
-
 static void on_gui_widget_destroy(GtkWidget*, gpointer data)
 {
     plugin_gui *gui = (plugin_gui *)data;
@@ -368,7 +361,11 @@ LV2UI_Handle gui_instantiate(const struct _LV2UI_Descriptor* descriptor,
         gtk_container_add( GTK_CONTAINER(eventbox), decoTable );
         gtk_widget_show_all(eventbox);
         gui->optwidget = eventbox;
-        proxy->source_id = g_timeout_add_full(G_PRIORITY_LOW, 1000/30, plugin_on_idle, gui, NULL); // 30 fps should be enough for everybody    
+        proxy->gui = gui;
+        gui_refresh_scheduler::get().set_frame_rate(proxy->get_config()->refresh_rate);
+        gui_refresh_scheduler::get().set_frame_budget(proxy->get_config()->frame_budget);
+        gui_refresh_scheduler::get().add_client(proxy);
+        proxy->scheduled = true;
         proxy->widget_destroyed_signal = g_signal_connect(G_OBJECT(gui->optwidget), "destroy", G_CALLBACK(on_gui_widget_destroy), (gpointer)gui);
     }
     std::string rcf = PKGLIBDIR "/styles/" + proxy->get_config()->style + "/gtk.rc";
@@ -420,8 +417,9 @@ void gui_cleanup(LV2UI_Handle handle)
 {
     plugin_gui *gui = (plugin_gui *)handle;
     lv2_plugin_proxy *proxy = dynamic_cast<lv2_plugin_proxy *>(gui->plugin);
-    if (proxy->source_id)
-        g_source_remove(proxy->source_id);
+    if (proxy->scheduled)
+        gui_refresh_scheduler::get().remove_client(proxy);
+    proxy->scheduled = false;
     // If the widget still exists, remove the handler
     if (gui->optwidget)
     {
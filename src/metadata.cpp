@@ -131,7 +131,7 @@ CALF_PORT_PROPS(phaser) = {
     { 4000,       0, 10800,  0, PF_FLOAT | PF_SCALE_LINEAR | PF_CTL_KNOB | PF_UNIT_CENTS, NULL, "mod_depth", "Mod depth" },
     { 0.1,    0.01, 20,    0, PF_FLOAT | PF_SCALE_LOG | PF_CTL_KNOB | PF_UNIT_HZ, NULL, "mod_rate", "Mod rate" },
     { 0.5,    -0.99, 0.99,  0, PF_FLOAT | PF_SCALE_PERC | PF_CTL_KNOB | PF_UNIT_COEF, NULL, "feedback", "Feedback" },
-    { 6,          1, 12,   12, PF_INT | PF_SCALE_LINEAR | PF_CTL_KNOB, NULL, "stages", "# Stages" },
+    { 6,          1, 24,   24, PF_INT | PF_SCALE_LINEAR | PF_CTL_KNOB, NULL, "stages", "# Stages" },
     { 180,        0, 360,   9, PF_FLOAT | PF_SCALE_LINEAR | PF_CTL_KNOB | PF_UNIT_DEG, NULL, "stereo", "Stereo phase" },
     { 0,          0, 1,     2, PF_BOOL | PF_CTL_BUTTON , NULL, "reset", "Reset" },
     { 0.5,          0, 4,     0, PF_FLOAT | PF_SCALE_GAIN | PF_CTL_KNOB | PF_UNIT_COEF | PF_PROP_NOBOUNDS, NULL, "amount", "Amount" },
@@ -353,6 +353,8 @@ CALF_PORT_NAMES(rotary_speaker) = {"In L", "In R", "Out L", "Out R"};
 
 const char *rotary_speaker_speed_names[] = { "Off", "Chorale", "Tremolo", "HoldPedal", "ModWheel", "Manual" };
 
+const char *rotary_speaker_interp_names[] = { "Linear", "Cubic" };
+
 CALF_PORT_PROPS(rotary_speaker) = {
     { 5,         0,  5, 1.01, PF_ENUM | PF_CTL_COMBO, rotary_speaker_speed_names, "vib_speed", "Speed Mode" },
     { 0.5,        0,    1,    0, PF_FLOAT | PF_CTL_KNOB | PF_SCALE_PERC, NULL, "spacing", "Tap Spacing" },
@@ -370,6 +372,7 @@ CALF_PORT_PROPS(rotary_speaker) = {
     { 1,           0.015625,    64,    0,  PF_FLOAT | PF_SCALE_GAIN | PF_CTL_KNOB | PF_UNIT_DB | PF_PROP_NOBOUNDS, NULL, "level_in", "Input Gain" }, \
     { 2,           0.015625,    64,    0,  PF_FLOAT | PF_SCALE_GAIN | PF_CTL_KNOB | PF_UNIT_DB | PF_PROP_NOBOUNDS, NULL, "level_out", "Output Gain" },
     METERING_PARAMS
+    { 0,         0,  1,    0, PF_ENUM | PF_CTL_COMBO, rotary_speaker_interp_names, "interp", "Interpolation" },
     {}
 };
 
@@ -1258,6 +1261,8 @@ CALF_PLUGIN_INFO(ringmodulator) = { 0x8514, "RingModulator", "Calf Ring Modulato
 
 CALF_PORT_NAMES(saturator) = {"In L", "In R", "Out L", "Out R"};
 
+const char *distortion_quality_names[] = { "Oversampled", "ADAA", "ADAA 2x" };
+
 CALF_PORT_PROPS(saturator) = {
     BYPASS_AND_LEVEL_PARAMS
     METERING_PARAMS
@@ -1278,6 +1283,7 @@ CALF_PORT_PROPS(saturator) = {
 
     { 0,           0,           1,     0,  PF_BOOL | PF_CTL_TOGGLE, NULL, "pre", "Activate Pre" },
     { 0,           0,           1,     0,  PF_BOOL | PF_CTL_TOGGLE, NULL, "post", "Activate Post" },
+    { 0,           0,           2,     0,  PF_ENUM | PF_CTL_COMBO, distortion_quality_names, "quality", "Antialiasing" },
 
     {}
 };
@@ -1306,6 +1312,7 @@ CALF_PORT_PROPS(exciter) = {
     { 0,          0,            1,     0,  PF_BOOL | PF_CTL_TOGGLE, NULL, "listen", "Listen" },
     { 0,          0,            1,     0,  PF_BOOL | PF_CTL_TOGGLE, NULL, "ceil_active", "Ceiling active" },
     { 16000,      10000,        20000, 0,  PF_FLOAT | PF_SCALE_LOG | PF_CTL_KNOB | PF_UNIT_HZ, NULL, "ceil", "Ceiling" },
+    { 0,           0,           2,     0,  PF_ENUM | PF_CTL_COMBO, distortion_quality_names, "quality", "Antialiasing" },
     {}
 };
 
@@ -1333,6 +1340,7 @@ CALF_PORT_PROPS(bassenhancer) = {
     { 0,          0,            1,     0,  PF_BOOL | PF_CTL_TOGGLE, NULL, "listen", "Listen" },
     { 0,           0,           1,     0,  PF_BOOL | PF_CTL_TOGGLE, NULL, "floor_active", "Floor active" },
     { 20,         10,           120,   0,  PF_FLOAT | PF_SCALE_LOG | PF_CTL_KNOB | PF_UNIT_HZ, NULL, "floor", "Floor" },
+    { 0,           0,           2,     0,  PF_ENUM | PF_CTL_COMBO, distortion_quality_names, "quality", "Antialiasing" },
     {}
 };
 
@@ -1407,6 +1415,7 @@ CALF_PORT_PROPS(multibandenhancer) = {
     { 0,         0,           1,     0, PF_BOOL | PF_CTL_TOGGLE, NULL, "solo2", "Solo 3" },
     { 0,         0,           1,     0, PF_BOOL | PF_CTL_TOGGLE, NULL, "solo3", "Solo 4" },
 
+    { 0,           0,           2,     0,  PF_ENUM | PF_CTL_COMBO, distortion_quality_names, "quality", "Antialiasing" },
     {}
 };
 
@@ -1814,6 +1823,9 @@ const char *organ_routing_names[] = { "Out", "Flt 1", "Flt 2"  };
 
 const char *organ_ampctl_names[] = { "None", "Direct", "Flt 1", "Flt 2", "All"  };
 
+/// Voice stealing policies of organ and wavetable, in dsp::voice_steal_policy order
+const char *voice_steal_names[] = { "Oldest", "Quietest", "Same note" };
+
 const char *organ_vibrato_mode_names[] = { "None", "Direct", "Flt 1", "Flt 2", "Voice", "Global"  };
 
 const char *organ_vibrato_type_names[] = { "Allpass", "Scanner (V1/C1)", "Scanner (V2/C2)", "Scanner (V3/C3)", "Scanner (Full)"  };
@@ -1976,6 +1988,8 @@ CALF_PORT_PROPS(organ) = {
     { 1,        0.1, 10,     0, PF_FLOAT | PF_SCALE_GAIN | PF_CTL_KNOB | PF_UNIT_COEF | PF_PROP_NOBOUNDS, NULL, "treble_gain", "Treble Gain" },
     
     { 0,       0,   16,    0, PF_INT | PF_SCALE_LINEAR | PF_CTL_KNOB , NULL, "midi", "MIDI Channel" },
+
+    { 0,          0,    2,    0, PF_ENUM | PF_CTL_COMBO, voice_steal_names, "steal", "Voice Stealing" },
 };
 
 void organ_metadata::get_configure_vars(vector<string> &names) const
@@ -2116,6 +2130,7 @@ CALF_PORT_PROPS(wavetable) = {
     { 0.25,       0.01, 20,    0, PF_FLOAT | PF_SCALE_LOG | PF_CTL_KNOB | PF_UNIT_HZ, NULL, "lfo2_rate", "LFO2 Rate" },
     
     { 0,       0,   16,    0, PF_INT | PF_SCALE_LINEAR | PF_CTL_KNOB , NULL, "midi", "MIDI Channel" },
+    { 0,          0,    2,    0, PF_ENUM | PF_CTL_COMBO, voice_steal_names, "steal", "Voice Stealing" },
     {}
 };
 
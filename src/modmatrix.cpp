@@ -35,6 +35,18 @@ mod_matrix_impl::mod_matrix_impl(dsp::modulation_entry *_matrix, mod_matrix_meta
     matrix_rows = metadata->get_table_rows();
     for (unsigned int i = 0; i < matrix_rows; i++)
         matrix[i].reset();
+    program_rows = new compiled_row[3 * matrix_rows];
+    for (int i = 0; i < 3; i++)
+    {
+        program.get_slot(i).rows = program_rows + i * matrix_rows;
+        program.get_slot(i).count = 0;
+    }
+    compile_matrix();
+}
+
+mod_matrix_impl::~mod_matrix_impl()
+{
+    delete []program_rows;
 }
 
 const float mod_matrix_impl::scaling_coeffs[mod_matrix_metadata::map_type_count][3] = {
@@ -48,6 +60,42 @@ const float mod_matrix_impl::scaling_coeffs[mod_matrix_metadata::map_type_count]
     { 0, 4, -4 },
 };
 
+void mod_matrix_impl::compile_matrix()
+{
+    // the audio thread may still be running the previous program, so build
+    // the new one in a spare copy and swap it in when complete
+    compiled_program &prog = program.get_write();
+    compiled_row *rows = prog.rows;
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < matrix_rows; i++)
+    {
+        const modulation_entry &slot = matrix[i];
+        // rows without destination or with zero amount don't contribute anything
+        if (!slot.dest || slot.amount == 0.f)
+            continue;
+        // insertion sort by destination, then mapping mode, so that consecutive
+        // instructions accumulate into the same output
+        unsigned int pos = count;
+        while(pos > 0 && (rows[pos - 1].dest > slot.dest || (rows[pos - 1].dest == slot.dest && rows[pos - 1].mapping > slot.mapping)))
+        {
+            rows[pos] = rows[pos - 1];
+            pos--;
+        }
+        const float *c = scaling_coeffs[slot.mapping];
+        compiled_row &row = rows[pos];
+        row.src1 = slot.src1;
+        row.src2 = slot.src2;
+        row.dest = slot.dest;
+        row.mapping = slot.mapping;
+        row.c0 = c[0] * slot.amount;
+        row.c1 = c[1] * slot.amount;
+        row.c2 = c[2] * slot.amount;
+        count++;
+    }
+    prog.count = count;
+    program.publish();
+}
+
 std::string mod_matrix_impl::get_cell(int row, int column) const
 {
     assert(row >= 0 && row < (int)matrix_rows);
@@ -149,6 +197,7 @@ char *mod_matrix_impl::configure(const char *key, const char *value)
                 case 3: slot.amount = src->amount; break;
                 case 4: slot.dest = src->dest; break;                    
                 }
+                compile_matrix();
                 return NULL;
             }
             const table_column_info &ci = metadata->get_table_columns()[column];
@@ -162,6 +211,7 @@ char *mod_matrix_impl::configure(const char *key, const char *value)
         set_cell(row, column, value, error);
         if (!error.empty())
             return strdup(error.c_str());
+        compile_matrix();
     }
     return NULL;
 }
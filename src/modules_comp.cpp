@@ -768,6 +768,12 @@ void compressor_audio_module::params_changed()
     compressor.set_params(*params[param_attack], *params[param_release], *params[param_threshold], *params[param_ratio], *params[param_knee], *params[param_makeup], *params[param_detection], *params[param_stereo_link], *params[param_bypass], 0.f);
 }
 
+int compressor_audio_module::get_tail_length() const
+{
+    // silence in, silence out - only the reduction meter needs to return to 0 dB
+    return (int)(srate * *params[param_release] * 0.001f) + vumeters::settle_time(srate);
+}
+
 void compressor_audio_module::set_sample_rate(uint32_t sr)
 {
     srate = sr;
@@ -783,11 +789,11 @@ uint32_t compressor_audio_module::process(uint32_t offset, uint32_t numsamples,
     numsamples += offset;
     if(bypassed) {
         // everything bypassed
+        float values[] = {0, 0, 1};
+        meters.process_constant(values, numsamples - offset);
         while(offset < numsamples) {
             outs[0][offset] = ins[0][offset];
             outs[1][offset] = ins[1][offset];
-            float values[] = {0, 0, 1};
-            meters.process(values);
             ++offset;
         }
         // displays, too
@@ -882,7 +888,8 @@ void sidechaincompressor_audio_module::activate()
     is_active = true;
     // set all filters and strips
     compressor.activate();
-    params_changed();
+    control_tick();
+    set_control_period(DEFAULT_CONTROL_PERIOD);
 }
 void sidechaincompressor_audio_module::deactivate()
 {
@@ -924,7 +931,7 @@ float sidechaincompressor_audio_module::freq_gain(int index, double freq) const
     return std::abs(h_z(z));
 }
 
-void sidechaincompressor_audio_module::params_changed()
+void sidechaincompressor_audio_module::control_tick()
 {
     // set the params of all filters
     if(*params[param_f1_freq] != f1_freq_old || *params[param_f1_level] != f1_level_old
@@ -1060,11 +1067,11 @@ uint32_t sidechaincompressor_audio_module::process(uint32_t offset, uint32_t num
     numsamples += offset;
     if(bypassed) {
         // everything bypassed
+        float values[] = {0, 0, 1};
+        meters.process_constant(values, numsamples - offset);
         while(offset < numsamples) {
             outs[0][offset] = ins[0][offset];
             outs[1][offset] = ins[1][offset];
-            float values[] = {0, 0, 1};
-            meters.process(values);
             ++offset;
         }
     } else {
@@ -1254,6 +1261,7 @@ void multibandcompressor_audio_module::activate()
         strip[j].activate();
         strip[j].id = j;
     }
+    smoothed.reset();
 }
 
 void multibandcompressor_audio_module::deactivate()
@@ -1323,6 +1331,8 @@ void multibandcompressor_audio_module::set_sample_rate(uint32_t sr)
                    param_output3, -param_compression3 };
     int clip[] = {param_clip_inL, param_clip_inR, param_clip_outL, param_clip_outR, -1, -1, -1, -1, -1, -1, -1, -1};
     meters.init(params, meter, clip, 12, srate);
+    int smooth[] = {param_level_in, param_level_out};
+    smoothed.init(params, smooth, SMOOTH_COUNT, srate);
 }
 
 uint32_t multibandcompressor_audio_module::process(uint32_t offset, uint32_t numsamples, uint32_t inputs_mask, uint32_t outputs_mask)
@@ -1334,24 +1344,28 @@ uint32_t multibandcompressor_audio_module::process(uint32_t offset, uint32_t num
         strip[i].update_curve();
     if(bypassed) {
         // everything bypassed
+        float values[] = {0, 0, 0, 0, 0, 1, 0, 1, 0, 1, 0, 1};
+        meters.process_constant(values, numsamples - offset);
         while(offset < numsamples) {
             outs[0][offset] = ins[0][offset];
             outs[1][offset] = ins[1][offset];
-            float values[] = {0, 0, 0, 0, 0, 1, 0, 1, 0, 1, 0, 1};
-            meters.process(values);
             ++offset;
         }
     } else {
         // process all strips
         uint32_t orig_numsamples = numsamples-offset;
         uint32_t orig_offset = offset;
+        smoothed.update(orig_numsamples);
+        bool strip_bypass[strips] = {*params[param_bypass0] > 0.5f, *params[param_bypass1] > 0.5f,
+                                     *params[param_bypass2] > 0.5f, *params[param_bypass3] > 0.5f};
         while(offset < numsamples) {
             // cycle through samples
             float inL = ins[0][offset];
             float inR = ins[1][offset];
             // in level
-            inR *= *params[param_level_in];
-            inL *= *params[param_level_in];
+            float level_in = smoothed.get(SMOOTH_LEVEL_IN, offset - orig_offset);
+            inR *= level_in;
+            inL *= level_in;
             // process crossover
             xin[0] = inL;
             xin[1] = inR;
@@ -1374,18 +1388,19 @@ uint32_t multibandcompressor_audio_module::process(uint32_t offset, uint32_t num
             } // process single strip
 
             // out level
-            outL *= *params[param_level_out];
-            outR *= *params[param_level_out];
+            float level_out = smoothed.get(SMOOTH_LEVEL_OUT, offset - orig_offset);
+            outL *= level_out;
+            outR *= level_out;
 
             // send to output
             outs[0][offset] = outL;
             outs[1][offset] = outR;
             
             float values[] = {inL, inR, outL, outR,
-                *params[param_bypass0] > 0.5f ? 0 : strip[0].get_output_level(), *params[param_bypass0] > 0.5f ? 1 : strip[0].get_comp_level(),
-                *params[param_bypass1] > 0.5f ? 0 : strip[1].get_output_level(), *params[param_bypass1] > 0.5f ? 1 : strip[1].get_comp_level(),
-                *params[param_bypass2] > 0.5f ? 0 : strip[2].get_output_level(), *params[param_bypass2] > 0.5f ? 1 : strip[2].get_comp_level(),
-                *params[param_bypass3] > 0.5f ? 0 : strip[3].get_output_level(), *params[param_bypass3] > 0.5f ? 1 : strip[3].get_comp_level() };
+                strip_bypass[0] ? 0 : strip[0].get_output_level(), strip_bypass[0] ? 1 : strip[0].get_comp_level(),
+                strip_bypass[1] ? 0 : strip[1].get_output_level(), strip_bypass[1] ? 1 : strip[1].get_comp_level(),
+                strip_bypass[2] ? 0 : strip[2].get_output_level(), strip_bypass[2] ? 1 : strip[2].get_comp_level(),
+                strip_bypass[3] ? 0 : strip[3].get_output_level(), strip_bypass[3] ? 1 : strip[3].get_comp_level() };
             meters.process(values);
                 
             // next sample
@@ -1519,10 +1534,10 @@ uint32_t monocompressor_audio_module::process(uint32_t offset, uint32_t numsampl
     numsamples += offset;
     if(bypassed) {
         // everything bypassed
+        float values[] = {0, 0, 1};
+        meters.process_constant(values, numsamples - offset);
         while(offset < numsamples) {
             outs[0][offset] = ins[0][offset];
-            float values[] = {0, 0, 1};
-            meters.process(values);
             ++offset;
         }
     } else {
@@ -1682,11 +1697,11 @@ uint32_t deesser_audio_module::process(uint32_t offset, uint32_t numsamples, uin
     float gain = 1.f;
     if(bypassed) {
         // everything bypassed
+        float values[] = {0, 1};
+        meters.process_constant(values, numsamples - offset);
         while(offset < numsamples) {
             outs[0][offset] = ins[0][offset];
             outs[1][offset] = ins[1][offset];
-            float values[] = {0, 1};
-            meters.process(values);
             ++offset;
         }
     } else {
@@ -1815,11 +1830,11 @@ uint32_t gate_audio_module::process(uint32_t offset, uint32_t numsamples, uint32
     numsamples += offset;
     if(bypassed) {
         // everything bypassed
+        float values[] = {0, 0, 1};
+        meters.process_constant(values, numsamples - offset);
         while(offset < numsamples) {
             outs[0][offset] = ins[0][offset];
             outs[1][offset] = ins[1][offset];
-            float values[] = {0, 0, 1};
-            meters.process(values);
             ++offset;
         }
     } else {
@@ -2077,11 +2092,11 @@ uint32_t sidechaingate_audio_module::process(uint32_t offset, uint32_t numsample
     numsamples += offset;
     if(bypassed) {
         // everything bypassed
+        float values[] = {0, 0, 1};
+        meters.process_constant(values, numsamples - offset);
         while(offset < numsamples) {
             outs[0][offset] = ins[0][offset];
             outs[1][offset] = ins[1][offset];
-            float values[] = {0, 0, 1};
-            meters.process(values);
             ++offset;
         }
     } else {
@@ -2346,11 +2361,11 @@ uint32_t multibandgate_audio_module::process(uint32_t offset, uint32_t numsample
         gate[i].update_curve();
     if(bypassed) {
         // everything bypassed
+        float values[] = {0, 0, 0, 0, 0, 1, 0, 1, 0, 1, 0, 1};
+        meters.process_constant(values, numsamples - offset);
         while(offset < numsamples) {
             outs[0][offset] = ins[0][offset];
             outs[1][offset] = ins[1][offset];
-            float values[] = {0, 0, 0, 0, 0, 1, 0, 1, 0, 1, 0, 1};
-            meters.process(values);
             ++offset;
         }
     } else {
@@ -76,8 +76,18 @@ void reverb_audio_module::params_changed()
     predelay_amt = (int) (srate * (*params[par_predelay]) * (1.0f / 1000.0f) + 1);
 }
 
+int reverb_audio_module::get_tail_length() const
+{
+    // the decay time is where the tail is down by 60-70 dB, give it some more
+    return predelay_amt + (int)(srate * *params[par_decay] * 1.5f) + vumeters::settle_time(srate);
+}
+
 uint32_t reverb_audio_module::process(uint32_t offset, uint32_t numsamples, uint32_t inputs_mask, uint32_t outputs_mask)
 {
+    const float *buffers[] = {ins[0], ins[1], outs[0], outs[1]};
+    float gains[] = {*params[param_level_in], *params[param_level_in], 1, 1};
+    // input meters first, the host may process in place
+    meters.process(buffers, gains, offset, numsamples, 0, 2);
     numsamples += offset;
     for (uint32_t i = offset; i < numsamples; i++) {
         float dry = dryamount.get();
@@ -99,10 +109,8 @@ uint32_t reverb_audio_module::process(uint32_t offset, uint32_t numsamples, uint
         }
         outs[0][i] *= *params[param_level_out];
         outs[1][i] *= *params[param_level_out];
-        
-        float values[] = {s.left, s.right, outs[0][i], outs[1][i]};
-        meters.process(values);
     }
+    meters.process(buffers, gains, offset, numsamples - offset, 2, 2);
     meters.fall(numsamples);
     reverb.extra_sanitize();
     left_lo.sanitize();
@@ -119,12 +127,11 @@ uint32_t reverb_audio_module::process(uint32_t offset, uint32_t numsamples, uint
 vintage_delay_audio_module::vintage_delay_audio_module()
 {
     old_medium = -1;
-    for (int i = 0; i < MAX_DELAY; i++) {
-        buffers[0][i] = 0.f;
-        buffers[1][i] = 0.f;
-    }
+    buf_size = buf_mask = 0;
+    bufptr = age = 0;
     _tap_avg = 0;
     _tap_last = 0;
+    tail_length = -1;
 }
 
 char *vintage_delay_audio_module::configure(const char *key, const char *value)
@@ -142,7 +149,7 @@ char *vintage_delay_audio_module::configure(const char *key, const char *value)
     return strdup("Unsupported key");
 }
 
-void vintage_delay_audio_module::params_changed()
+void vintage_delay_audio_module::control_tick()
 {
     double bpm = 120;
     bpm = convert_periodic(*params[param_bpm + (int)((periodic_unit)int(*params[param_timing]))],
@@ -159,8 +166,10 @@ void vintage_delay_audio_module::params_changed()
     //}
     
     float unit = 60.0 * srate / (bpm * *params[par_divide]);
-    deltime_l = dsp::fastf2i_drm(unit * *params[par_time_l]);
-    deltime_r = dsp::fastf2i_drm(unit * *params[par_time_r]);
+    // host tempo and Hz based timing can go below what the buffers are sized for
+    int max_deltime = std::max<int>(1, buffers[0].size() / 2 - 1);
+    deltime_l = std::min(dsp::fastf2i_drm(unit * *params[par_time_l]), max_deltime);
+    deltime_r = std::min(dsp::fastf2i_drm(unit * *params[par_time_r]), max_deltime);
     int deltime_fb = deltime_l + deltime_r;
     float fb = *params[par_feedback];
     dry.set_inertia(*params[par_dryamount]);
@@ -198,12 +207,21 @@ void vintage_delay_audio_module::params_changed()
     chmix.set_inertia((1 - *params[par_width]) * 0.5);
     if (medium != old_medium)
         calc_filters();
+    // echoes until the feedback brings them 90 dB down, no suspending with (almost) infinite feedback
+    int longest = (mixmode == MIXMODE_LR || mixmode == MIXMODE_RL) ? deltime_fb : std::max(deltime_l, deltime_r);
+    float repeats = fb > 0.f ? log(3.2e-5) / log(fb) : 0.f;
+    if (fb < 0.999f && repeats * longest < (float)(INT_MAX / 2))
+        tail_length = (int)((repeats + 1) * longest) + vumeters::settle_time(srate);
+    else
+        tail_length = -1;
 }
 
 void vintage_delay_audio_module::activate()
 {
     bufptr = 0;
     age = 0;
+    smoothed.reset();
+    set_control_period(DEFAULT_CONTROL_PERIOD);
 }
 
 void vintage_delay_audio_module::deactivate()
@@ -214,12 +232,27 @@ void vintage_delay_audio_module::set_sample_rate(uint32_t sr)
 {
     srate = sr;
     old_medium = -1;
+    // room for the longest delay (at the lowest tempo) in the LR/RL modes,
+    // which read the line at deltime_l + deltime_r; the pages are only
+    // backed by memory once the write pointer gets to them
+    int max_deltime = (int)(60.0 * sr / (param_props[param_bpm].min * param_props[par_divide].min) * param_props[par_time_l].max);
+    int size = MIN_DELAY;
+    while (size < 2 * max_deltime)
+        size *= 2;
+    buffers[0].allocate(size);
+    buffers[1].allocate(size);
+    buf_size = size;
+    buf_mask = buf_size - 1;
+    bufptr = 0;
+    age = 0;
     amt_left.set_sample_rate(sr); amt_right.set_sample_rate(sr);
     fb_left.set_sample_rate(sr); fb_right.set_sample_rate(sr);
 
     int meter[] = {param_meter_inL, param_meter_inR, param_meter_outL, param_meter_outR};
     int clip[] = {param_clip_inL, param_clip_inR, param_clip_outL, param_clip_outR};
     meters.init(params, meter, clip, 4, srate);
+    int smooth[] = {param_level_in, param_level_out};
+    smoothed.init(params, smooth, SMOOTH_COUNT, srate);
 }
 
 void vintage_delay_audio_module::calc_filters()
@@ -283,6 +316,12 @@ uint32_t vintage_delay_audio_module::process(uint32_t offset, uint32_t numsample
     uint32_t end = offset + numsamples;
     int orig_bufptr = bufptr;
     float out_left, out_right, del_left, del_right, inL, inR;
+    bool on = *params[param_on] > 0.5;
+    smoothed.update(numsamples);
+    const float *meter_buffers[] = {ins[0], ins[1], outs[0], outs[1]};
+    float gains[] = {smoothed.get(SMOOTH_LEVEL_IN), smoothed.get(SMOOTH_LEVEL_IN), 1, 1};
+    // input meters first, the host may process in place
+    meters.process(meter_buffers, gains, offset, numsamples, 0, 2);
     
     switch(mixmode)
     {
@@ -292,19 +331,19 @@ uint32_t vintage_delay_audio_module::process(uint32_t offset, uint32_t numsample
             int v = mixmode == MIXMODE_PINGPONG ? 1 : 0;
             for(uint32_t i = offset; i < end; i++)
             {       
-                inL = ins[0][i] * *params[param_level_in];
-                inR = ins[1][i] * *params[param_level_in];
-                delayline_impl(age, deltime_l, *params[param_on] > 0.5 ? inL : 0, buffers[v][(bufptr - deltime_l) & ADDR_MASK], out_left, del_left, amt_left, fb_left);
-                delayline_impl(age, deltime_r, *params[param_on] > 0.5 ? inR : 0, buffers[1 - v][(bufptr - deltime_r) & ADDR_MASK], out_right, del_right, amt_right, fb_right);
+                float level_in = smoothed.get(SMOOTH_LEVEL_IN, i - offset);
+                inL = ins[0][i] * level_in;
+                inR = ins[1][i] * level_in;
+                delayline_impl(age, deltime_l, on ? inL : 0, buffers[v][(bufptr - deltime_l) & buf_mask], out_left, del_left, amt_left, fb_left);
+                delayline_impl(age, deltime_r, on ? inR : 0, buffers[1 - v][(bufptr - deltime_r) & buf_mask], out_right, del_right, amt_right, fb_right);
                 delay_mix(inL, inR, out_left, out_right, dry.get(), chmix.get());
                 
                 age++;
-                outs[0][i] = out_left * *params[param_level_out];
-                outs[1][i] = out_right * *params[param_level_out];
+                float level_out = smoothed.get(SMOOTH_LEVEL_OUT, i - offset);
+                outs[0][i] = out_left * level_out;
+                outs[1][i] = out_right * level_out;
                 buffers[0][bufptr] = del_left; buffers[1][bufptr] = del_right;
-                bufptr = (bufptr + 1) & (MAX_DELAY - 1);
-                float values[] = {inL, inR, outs[0][i], outs[1][i]};
-                meters.process(values);
+                bufptr = (bufptr + 1) & buf_mask;
             }
         }
         break;
@@ -319,24 +358,25 @@ uint32_t vintage_delay_audio_module::process(uint32_t offset, uint32_t numsample
             
             for(uint32_t i = offset; i < end; i++)
             {
-                inL = ins[0][i] * *params[param_level_in];
-                inR = ins[1][i] * *params[param_level_in];
-                delayline2_impl(age, deltime_l, *params[param_on] > 0.5 ? inL : 0, buffers[v][(bufptr - deltime_l_corr) & ADDR_MASK], buffers[v][(bufptr - deltime_fb) & ADDR_MASK], out_left, del_left, amt_left, fb_left);
-                delayline2_impl(age, deltime_r, *params[param_on] > 0.5 ? inR : 0, buffers[1 - v][(bufptr - deltime_r_corr) & ADDR_MASK], buffers[1-v][(bufptr - deltime_fb) & ADDR_MASK], out_right, del_right, amt_right, fb_right);
+                float level_in = smoothed.get(SMOOTH_LEVEL_IN, i - offset);
+                inL = ins[0][i] * level_in;
+                inR = ins[1][i] * level_in;
+                delayline2_impl(age, deltime_l, on ? inL : 0, buffers[v][(bufptr - deltime_l_corr) & buf_mask], buffers[v][(bufptr - deltime_fb) & buf_mask], out_left, del_left, amt_left, fb_left);
+                delayline2_impl(age, deltime_r, on ? inR : 0, buffers[1 - v][(bufptr - deltime_r_corr) & buf_mask], buffers[1-v][(bufptr - deltime_fb) & buf_mask], out_right, del_right, amt_right, fb_right);
                 delay_mix(inL, inR, out_left, out_right, dry.get(), chmix.get());
                 
                 age++;
-                outs[0][i] = out_left * *params[param_level_out];
-                outs[1][i] = out_right * *params[param_level_out];
+                float level_out = smoothed.get(SMOOTH_LEVEL_OUT, i - offset);
+                outs[0][i] = out_left * level_out;
+                outs[1][i] = out_right * level_out;
                 buffers[0][bufptr] = del_left; buffers[1][bufptr] = del_right;
-                bufptr = (bufptr + 1) & (MAX_DELAY - 1);
-                float values[] = {inL, inR, outs[0][i], outs[1][i]};
-                meters.process(values);
+                bufptr = (bufptr + 1) & buf_mask;
             }
         }
     }
-    if (age >= MAX_DELAY)
-        age = MAX_DELAY;
+    meters.process(meter_buffers, gains, offset, numsamples, 2, 2);
+    if (age >= buf_size)
+        age = buf_size;
     if (medium > 0) {
         bufptr = orig_bufptr;
         if (medium == 2)
@@ -345,7 +385,7 @@ uint32_t vintage_delay_audio_module::process(uint32_t offset, uint32_t numsample
             {
                 buffers[0][bufptr] = biquad_left[0].process_lp(biquad_left[1].process(buffers[0][bufptr]));
                 buffers[1][bufptr] = biquad_right[0].process_lp(biquad_right[1].process(buffers[1][bufptr]));
-                bufptr = (bufptr + 1) & (MAX_DELAY - 1);
+                bufptr = (bufptr + 1) & buf_mask;
             }
             biquad_left[0].sanitize();biquad_right[0].sanitize();
         } else {
@@ -353,7 +393,7 @@ uint32_t vintage_delay_audio_module::process(uint32_t offset, uint32_t numsample
             {
                 buffers[0][bufptr] = biquad_left[1].process(buffers[0][bufptr]);
                 buffers[1][bufptr] = biquad_right[1].process(buffers[1][bufptr]);
-                bufptr = (bufptr + 1) & (MAX_DELAY - 1);
+                bufptr = (bufptr + 1) & buf_mask;
             }
         }
         biquad_left[1].sanitize();biquad_right[1].sanitize();
@@ -440,6 +480,7 @@ uint32_t comp_delay_audio_module::process(uint32_t offset, uint32_t numsamples,
     
     if (bypassed) {
         float values[] = {0,0,0,0};
+        meters.process_constant(values, numsamples);
         while(offset < end) {
             outs[0][offset] = ins[0][offset];
             buffer[w_ptr]   = ins[0][offset];
@@ -448,7 +489,6 @@ uint32_t comp_delay_audio_module::process(uint32_t offset, uint32_t numsamples,
                 buffer[w_ptr + 1] = ins[1][offset];
             }
             w_ptr = (w_ptr + 2) & b_mask;
-            meters.process(values);
             ++offset;
         }
     } else {
@@ -471,10 +511,10 @@ uint32_t comp_delay_audio_module::process(uint32_t offset, uint32_t numsamples,
             }
             w_ptr = (w_ptr + 2) & b_mask;
             r_ptr = (r_ptr + 2) & b_mask;
-            
-            float values[] = {L, R, outs[0][i], outs[1][i]};
-            meters.process(values);
         }
+        const float *buffers[] = {ins[0], stereo ? ins[1] : NULL, outs[0], stereo ? outs[1] : NULL};
+        float gains[] = {*params[param_level_in], *params[param_level_in], 1, 1};
+        meters.process(buffers, gains, offset, numsamples);
     }
     if (!bypassed)
         bypass.crossfade(ins, outs, stereo ? 2 : 1, off, numsamples);
@@ -638,10 +678,8 @@ uint32_t haas_enhancer_audio_module::process(uint32_t offset, uint32_t numsample
 
 reverse_delay_audio_module::reverse_delay_audio_module()
 {
-    for (int i = 0; i < MAX_DELAY; i++) {
-        buffers[0][i] = 0.f;
-        buffers[1][i] = 0.f;
-    }
+    buf_used = 0;
+    deltime_l = deltime_r = 1;
 
     counters[0] = 0;
     counters[1] = 0;
@@ -655,10 +693,11 @@ void reverse_delay_audio_module::params_changed()
     if (*params[par_sync] > 0.5f)
         *params[par_bpm] = *params[par_bpm_host];
 
-    //Max delay line length: (60*192000/30)*16 = 6144000, see buffers declaration
+    //Host tempo can go below the minimum the buffers are sized for, see set_sample_rate
+    int max_deltime = std::max<int>(1, buffers[0].size());
     float unit = 60.0 * srate / (*params[par_bpm] * *params[par_divide]);
-    deltime_l = dsp::fastf2i_drm(unit * *params[par_time_l]);
-    deltime_r = dsp::fastf2i_drm(unit * *params[par_time_r]);
+    deltime_l = std::min(dsp::fastf2i_drm(unit * *params[par_time_l]), max_deltime);
+    deltime_r = std::min(dsp::fastf2i_drm(unit * *params[par_time_r]), max_deltime);
 
     fb_val.set_inertia(*params[par_feedback]);
     dry.set_inertia(*params[par_amount]);
@@ -671,17 +710,17 @@ void reverse_delay_audio_module::params_changed()
 
     width.set_inertia(*params[par_width]);
 
-    //Cleanup delay line buffers if reset
+    //Cleanup delay line buffers if reset - only the part that has been used
     if(*params[par_reset])
     {
-        for (int i = 0; i < MAX_DELAY; i++) {
-            buffers[0][i] = 0.f;
-            buffers[1][i] = 0.f;
-        }
+        for (int i = 0; i < 2; i++)
+            buffers[i].clear(0, buf_used);
+        buf_used = 0;
 
         feedback_buf[0] = 0;
         feedback_buf[1] = 0;
     }
+    buf_used = std::max(buf_used, std::max(deltime_l, deltime_r));
 }
 
 void reverse_delay_audio_module::activate()
@@ -695,6 +734,13 @@ void reverse_delay_audio_module::deactivate()
 void reverse_delay_audio_module::set_sample_rate(uint32_t sr)
 {
     srate = sr;
+    //Max delay line length: 16 beats at the slowest tempo, (60*192000/30)*16 = 6144000 at 192kHz
+    int max_deltime = (int)(60.0 * sr / (param_props[par_bpm].min * param_props[par_divide].min) * param_props[par_time_l].max);
+    buffers[0].allocate(max_deltime);
+    buffers[1].allocate(max_deltime);
+    buf_used = 0;
+    counters[0] = 0;
+    counters[1] = 0;
     fb_val.set_sample_rate(sr);
     dry.set_sample_rate(sr);
     width.set_sample_rate(sr);
@@ -745,8 +791,8 @@ uint32_t reverse_delay_audio_module::process(uint32_t offset, uint32_t numsample
         //Process
         float inL = 0., inR = 0., outL = 0., outR = 0.;
         if (bypassed) {
-            outs[0][offset] = ins[0][offset];
-            outs[1][offset] = ins[1][offset];
+            outs[0][i] = ins[0][i];
+            outs[1][i] = ins[1][i];
         } else {
             float feedback_val = fb_val.get();
             float st_width_val = width.get();
@@ -759,8 +805,8 @@ uint32_t reverse_delay_audio_module::process(uint32_t offset, uint32_t numsample
             inL = inL + feedback_buf[0]* feedback_val*(1 - st_width_val) + feedback_buf[1]* st_width_val*feedback_val;
             inR = inR + feedback_buf[1]* feedback_val*(1 - st_width_val) + feedback_buf[0]* st_width_val*feedback_val;
     
-            outL = reverse_delay_line_impl(inL, &buffers[0][0], &counters[0], deltime_l);
-            outR = reverse_delay_line_impl(inR, &buffers[1][0], &counters[1], deltime_r);
+            outL = reverse_delay_line_impl(inL, buffers[0].data(), &counters[0], deltime_l);
+            outR = reverse_delay_line_impl(inR, buffers[1].data(), &counters[1], deltime_r);
             feedback_buf[0] = outL;
             feedback_buf[1] = outR;
     
@@ -772,11 +818,12 @@ uint32_t reverse_delay_audio_module::process(uint32_t offset, uint32_t numsample
     
             outs[0][i] = outL * *params[param_level_out];
             outs[1][i] = outR * *params[param_level_out];
-            bypass.crossfade(ins, outs, 2, offset, numsamples);
         }
         float values[] = {inL, inR, outL, outR};
         meters.process(values);
     }
+    if (!bypassed)
+        bypass.crossfade(ins, outs, 2, offset, numsamples);
     meters.fall(numsamples);
     return ostate;
 }
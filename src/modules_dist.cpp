@@ -135,8 +135,11 @@ void saturator_audio_module::params_changed()
     }
     // set distortion
     dist[0].set_params(*params[param_blend], *params[param_drive]);
-    if(in_count > 1 && out_count > 1)
+    dist[0].set_quality((int)*params[param_quality]);
+    if(in_count > 1 && out_count > 1) {
         dist[1].set_params(*params[param_blend], *params[param_drive]);
+        dist[1].set_quality((int)*params[param_quality]);
+    }
 }
 
 void saturator_audio_module::set_sample_rate(uint32_t sr)
@@ -327,8 +330,11 @@ void exciter_audio_module::params_changed()
     }
     // set distortion
     dist[0].set_params(*params[param_blend], *params[param_drive]);
-    if(in_count > 1 && out_count > 1)
+    dist[0].set_quality((int)*params[param_quality]);
+    if(in_count > 1 && out_count > 1) {
         dist[1].set_params(*params[param_blend], *params[param_drive]);
+        dist[1].set_quality((int)*params[param_quality]);
+    }
 }
 
 void exciter_audio_module::set_sample_rate(uint32_t sr)
@@ -514,8 +520,11 @@ void bassenhancer_audio_module::params_changed()
     }
     // set distortion
     dist[0].set_params(*params[param_blend], *params[param_drive]);
-    if(in_count > 1 && out_count > 1)
+    dist[0].set_quality((int)*params[param_quality]);
+    if(in_count > 1 && out_count > 1) {
         dist[1].set_params(*params[param_blend], *params[param_drive]);
+        dist[1].set_quality((int)*params[param_quality]);
+    }
 }
 
 void bassenhancer_audio_module::set_sample_rate(uint32_t sr)
@@ -674,10 +683,13 @@ vinyl_audio_module::vinyl_audio_module() {
     meter_outL      = 0.f;
     meter_outR      = 0.f;
     dbufsize        = 0;
+    dbuf            = NULL;
     
     speed_old       = 0.f;
     freq_old        = 0.f;
     aging_old       = 0.f;
+    for (int i = 0; i < _synths; i++)
+        samples[i] = NULL;
 }
 
 void vinyl_audio_module::activate() {
@@ -708,8 +720,9 @@ void vinyl_audio_module::params_changed() {
                 filters[i][j].copy_coeffs(filters[0][j]);
         }
     }
+    // pitch range is one octave up or down
     for (int j = 0; j < _synths; j++) {
-        fluid_synth_pitch_bend(synth, j, (int)(*params[param_pitch0 + j * _synthsp] * 8191 + 8192));
+        layers[j].set_speed(pow(2.0, *params[param_pitch0 + j * _synthsp]), srate);
     }
 }
 
@@ -719,25 +732,16 @@ uint32_t vinyl_audio_module::process(uint32_t offset, uint32_t numsamples, uint3
 	STACKALLOC(float, sL, numsamples);
 	STACKALLOC(float, sR, numsamples);
     if (!bypassed) {
+        dsp::zero(sL, numsamples);
+        dsp::zero(sR, numsamples);
         for (int j = 0; j < _synths; ++j) {
             float gain = 0;
             if (*params[param_active0 + j * _synthsp] >= 0.5f) {
                 gain = *params[param_gain0 + j * _synthsp];
             }
-            if (gain == last_gain[j])
-                continue;
-            if (last_gain[j] == 0 && gain != 0) {
-                fluid_synth_noteon(synth, j, 60, 127);
-            }
-            if (last_gain[j] != 0 && gain == 0) {
-                fluid_synth_noteoff(synth, j, 60);
-            }
-            if (gain > 0) {
-                fluid_synth_set_gen(synth, j, GEN_ATTENUATION, 200 * log10(1.0 / gain));
-            }
-            last_gain[j] = gain;
+            layers[j].set_gain(gain);
+            layers[j].render_to(sL, sR, numsamples);
         }
-        fluid_synth_write_float(synth, numsamples, sL, 0, 1, sR, 0, 1);
     }
     for(uint32_t i = offset; i < offset + numsamples; i++) {
         float L = ins[0][i];
@@ -828,12 +832,6 @@ void vinyl_audio_module::post_instantiate(uint32_t sr)
     dbufrange = sr / 100.0;
     dbuf = (float*) calloc(dbufsize * channels, sizeof(float));
     dbufpos = 0;
-    settings = new_fluid_settings();
-    fluid_settings_setnum(settings, "synth.sample-rate", sr);
-    fluid_settings_setint(settings, "synth.polyphony", 32);
-    fluid_settings_setint(settings, "synth.midi-channels", _synths);
-    fluid_settings_setint(settings, "synth.reverb.active", 0);
-    fluid_settings_setint(settings, "synth.chorus.active", 0);
     
     char const * paths[] = {
         PKGLIBDIR "sf2/Hum.sf2",
@@ -844,20 +842,20 @@ void vinyl_audio_module::post_instantiate(uint32_t sr)
         PKGLIBDIR "sf2/Crackle.sf2",
         PKGLIBDIR "sf2/Crinkle.sf2"
     };
-    synth = new_fluid_synth(settings);
-    fluid_synth_set_gain(synth, 1.f);
+    // the noise layers are played straight from the sample data, which is
+    // loaded once for all instances; a missing file just leaves the layer silent
     for (int i = 0; i < _synths; i++) {
-        int id = fluid_synth_sfload(synth, paths[i], 0);
-        fluid_synth_program_select (synth, i, id, 0, 0);
-        fluid_synth_pitch_wheel_sens(synth, i, 12);
-        last_gain[i] = 0;
+        dsp::sf2_sample_cache::release(samples[i]);
+        samples[i] = dsp::sf2_sample_cache::acquire(paths[i]);
+        layers[i].set_sample(samples[i]);
+        layers[i].set_speed(1.0, sr);
     }
 }
 vinyl_audio_module::~vinyl_audio_module()
 {
+    for (int i = 0; i < _synths; i++)
+        dsp::sf2_sample_cache::release(samples[i]);
     free(dbuf);
-    delete_fluid_synth(synth);
-    delete_fluid_settings(settings);
 }
 
 
@@ -1226,11 +1224,11 @@ uint32_t crusher_audio_module::process(uint32_t offset, uint32_t numsamples, uin
     numsamples += offset;
     if(bypassed) {
         // everything bypassed
+        float values[] = {0, 0, 0, 0};
+        meters.process_constant(values, numsamples - offset);
         while(offset < numsamples) {
             outs[0][offset] = ins[0][offset];
             outs[1][offset] = ins[1][offset];
-            float values[] = {0, 0, 0, 0};
-            meters.process(values);
             ++offset;
         }
     } else {
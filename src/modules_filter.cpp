@@ -201,6 +201,7 @@ void equalizerNband_audio_module<BaseClass, has_lphp>::params_changed()
         redraw_graph = true;
         analyzer_old = (bool)*params[AM::param_analyzer_active];
     }
+    publish_graph();
 }
 
 template<class BaseClass, bool has_lphp>
@@ -285,11 +286,11 @@ uint32_t equalizerNband_audio_module<BaseClass, has_lphp>::process(uint32_t offs
     numsamples += offset;
     if(bypassed) {
         // everything bypassed
+        float values[] = {0, 0, 0, 0};
+        meters.process_constant(values, numsamples - offset);
         while(offset < numsamples) {
             outs[0][offset] = ins[0][offset];
             outs[1][offset] = ins[1][offset];
-            float values[] = {0, 0, 0, 0};
-            meters.process(values);
             _analyzer.process(0, 0);
             ++offset;
         }
@@ -351,12 +352,12 @@ uint32_t equalizerNband_audio_module<BaseClass, has_lphp>::process(uint32_t offs
             outs[0][offset] = outL;
             outs[1][offset] = outR;
             
-            float values[] = {inL, inR, outL, outR};
-            meters.process(values);
-
             // next sample
             ++offset;
         } // cycle trough samples
+        const float *buffers[] = {ins[0], ins[1], outs[0], outs[1]};
+        float gains[] = {*params[AM::param_level_in], *params[AM::param_level_in], 1, 1};
+        meters.process(buffers, gains, orig_offset, orig_numsamples);
         bypass.crossfade(ins, outs, 2, orig_offset, orig_numsamples);
         // clean up
         for(int i = 0; i < 3; ++i) {
@@ -376,34 +377,59 @@ uint32_t equalizerNband_audio_module<BaseClass, has_lphp>::process(uint32_t offs
     return outputs_mask;
 }
 
-static inline float adjusted_lphp_gain(const float *const *params, int param_active, int param_mode, const biquad_d2 &filter, float freq, float srate)
+/// number of times the HP/LP biquad is applied in the current mode (0 if inactive)
+static inline int lphp_stages(const float *const *params, int param_active, int param_mode)
 {
     if(*params[param_active] > 0.f) {
-        float gain = filter.freq_gain(freq, srate);
         switch((int)*params[param_mode]) {
             case MODE12DB:
-                return gain;
+                return 1;
             case MODE24DB:
-                return gain * gain;
+                return 2;
             case MODE36DB:
-                return gain * gain * gain;
+                return 3;
         }
     }
-    return 1;
+    return 0;
+}
+
+template<class BaseClass, bool has_lphp>
+void equalizerNband_audio_module<BaseClass, has_lphp>::publish_graph()
+{
+    graph_state &gs = graph.get_write();
+    gs.hp = hp[0][0];
+    gs.lp = lp[0][0];
+    gs.hp_stages = has_lphp ? lphp_stages(params, AM::param_hp_active, AM::param_hp_mode) : 0;
+    gs.lp_stages = has_lphp ? lphp_stages(params, AM::param_lp_active, AM::param_lp_mode) : 0;
+    gs.ls = lsL;
+    gs.hs = hsL;
+    gs.ls_active = *params[AM::param_ls_active] > 0.f;
+    gs.hs_active = *params[AM::param_hs_active] > 0.f;
+    for (int i = 0; i < PeakBands; i++) {
+        gs.p[i] = pL[i];
+        gs.p_active[i] = *params[AM::param_p1_active + i * params_per_band] > 0.f;
+    }
+    gs.individuals = *params[AM::param_individuals] != 0.f;
+    gs.analyzer_active = *params[AM::param_analyzer_active] != 0.f;
+    gs.analyzer_mode = (int)*params[AM::param_analyzer_mode];
+    gs.zoom = *params[AM::param_zoom];
+    gs.srate = srate;
+    graph.publish();
 }
 
 template<class BaseClass, bool has_lphp>
 bool equalizerNband_audio_module<BaseClass, has_lphp>::get_graph(int index, int subindex, int phase, float *data, int points, cairo_iface *context, int *mode) const
 {
-    if (phase && *params[AM::param_analyzer_active]) {
+    const graph_state &gs = graph.get_read();
+    if (phase && gs.analyzer_active) {
         bool r = _analyzer.get_graph(subindex, phase, data, points, context, mode);
-        if (*params[AM::param_analyzer_mode] == 2) {
+        if (gs.analyzer_mode == 2) {
             set_channel_color(context, subindex ? 0 : 1, 0.15);
         } else {
             context->set_source_rgba(0,0,0,0.1);
         }
         return r;
-    } else if (phase && !*params[AM::param_analyzer_active]) {
+    } else if (phase && !gs.analyzer_active) {
         last_peak = 0;
         redraw_graph = false;
         return false;
@@ -411,16 +437,27 @@ bool equalizerNband_audio_module<BaseClass, has_lphp>::get_graph(int index, int
         int max = PeakBands + 2 + (has_lphp ? 2 : 0);
         
         if (!is_active
-        || (subindex && !*params[AM::param_individuals])
-        || (subindex > max && *params[AM::param_individuals])) {
+        || (subindex && !gs.individuals)
+        || (subindex > max && gs.individuals)) {
             last_peak = 0;
             redraw_graph = false;
             return false;
         }
         
+        const freq_response_grid &grid = freq_response_grid::get(points, gs.srate);
         // first graph is the overall frequency response graph
-        if (!subindex)
-            return ::get_graph(*this, subindex, data, points, 128 * *params[AM::param_zoom], 0);
+        if (!subindex) {
+            biquad_response_cache &cache = response_cache[0];
+            cache.begin(grid);
+            cache.add(gs.hp, gs.hp_stages);
+            cache.add(gs.lp, gs.lp_stages);
+            cache.add(gs.ls, gs.ls_active);
+            cache.add(gs.hs, gs.hs_active);
+            for (int i = 0; i < PeakBands; i++)
+                cache.add(gs.p[i], gs.p_active[i]);
+            dB_grid(data, cache.get(), points, 128 * gs.zoom, 0);
+            return true;
+        }
         
         // get out if max band is reached
         if (last_peak >= max) {
@@ -431,15 +468,15 @@ bool equalizerNband_audio_module<BaseClass, has_lphp>::get_graph(int index, int
         
         // get the next filter to draw a curve for and leave out inactive
         // filters
-        while (last_peak < PeakBands && !*params[AM::param_p1_active + last_peak * params_per_band])
+        while (last_peak < PeakBands && !gs.p_active[last_peak])
             last_peak ++;
-        if (last_peak == PeakBands && !*params[AM::param_ls_active])
+        if (last_peak == PeakBands && !gs.ls_active)
             last_peak ++;
-        if (last_peak == PeakBands + 1 && !*params[AM::param_hs_active])
+        if (last_peak == PeakBands + 1 && !gs.hs_active)
             last_peak ++;
-        if (has_lphp && last_peak == PeakBands + 2 && !*params[AM::param_hp_active])
+        if (has_lphp && last_peak == PeakBands + 2 && !gs.hp_stages)
             last_peak ++;
-        if (has_lphp && last_peak == PeakBands + 3 && !*params[AM::param_lp_active])
+        if (has_lphp && last_peak == PeakBands + 3 && !gs.lp_stages)
             last_peak ++;
         
         // get out if max band is reached
@@ -456,21 +493,20 @@ bool equalizerNband_audio_module<BaseClass, has_lphp>::get_graph(int index, int
         //}
             
         // draw the individual curve of the actual filter
-        for (int i = 0; i < points; i++) {
-            double freq = 20.0 * pow (20000.0 / 20.0, i * 1.0 / points);
-            if (last_peak < PeakBands) {
-                data[i] = pL[last_peak].freq_gain(freq, (float)srate);
-            } else if (last_peak == PeakBands) {
-                data[i] = lsL.freq_gain(freq, (float)srate);
-            } else if (last_peak == PeakBands + 1) {
-                data[i] = hsL.freq_gain(freq, (float)srate);
-            } else if (last_peak == PeakBands + 2 && has_lphp) {
-                data[i] = adjusted_lphp_gain(params, AM::param_hp_active, AM::param_hp_mode, hp[0][0], freq, (float)srate);
-            } else if (last_peak == PeakBands + 3 && has_lphp) {
-                data[i] = adjusted_lphp_gain(params, AM::param_lp_active, AM::param_lp_mode, lp[0][0], freq, (float)srate);
-            }
-            data[i] = dB_grid(data[i], 128 * *params[AM::param_zoom], 0);
+        biquad_response_cache &cache = response_cache[1 + last_peak];
+        cache.begin(grid);
+        if (last_peak < PeakBands) {
+            cache.add(gs.p[last_peak]);
+        } else if (last_peak == PeakBands) {
+            cache.add(gs.ls);
+        } else if (last_peak == PeakBands + 1) {
+            cache.add(gs.hs);
+        } else if (last_peak == PeakBands + 2 && has_lphp) {
+            cache.add(gs.hp, gs.hp_stages);
+        } else if (last_peak == PeakBands + 3 && has_lphp) {
+            cache.add(gs.lp, gs.lp_stages);
         }
+        dB_grid(data, cache.get(), points, 128 * gs.zoom, 0);
         
         last_peak ++;
         *mode = 4;
@@ -481,10 +517,11 @@ bool equalizerNband_audio_module<BaseClass, has_lphp>::get_graph(int index, int
 template<class BaseClass, bool has_lphp>
 bool equalizerNband_audio_module<BaseClass, has_lphp>::get_layers(int index, int generation, unsigned int &layers) const
 {
+    bool analyzer_active = graph.get_read().analyzer_active;
     redraw_graph = redraw_graph || !generation;
-    layers = *params[AM::param_analyzer_active] ? LG_REALTIME_GRAPH : 0;
+    layers = analyzer_active ? LG_REALTIME_GRAPH : 0;
     layers |= (generation ? LG_NONE : LG_CACHE_GRID) | (redraw_graph ? LG_CACHE_GRAPH : LG_NONE);
-    redraw_graph |= (bool)*params[AM::param_analyzer_active];
+    redraw_graph |= analyzer_active;
     return redraw_graph || !generation;
 }
 
@@ -493,29 +530,29 @@ bool equalizerNband_audio_module<BaseClass, has_lphp>::get_gridline(int index, i
 {
     if (!is_active || phase)
         return false;
-    return get_freq_gridline(subindex, pos, vertical, legend, context, true, 128 * *params[AM::param_zoom], 0);
+    return get_freq_gridline(subindex, pos, vertical, legend, context, true, 128 * graph.get_read().zoom, 0);
 }
 
 template<class BaseClass, bool has_lphp>
 float equalizerNband_audio_module<BaseClass, has_lphp>::freq_gain(int index, double freq) const
 {
+    const graph_state &gs = graph.get_read();
     float ret = 1.f;
-    if (has_lphp)
-    {
-        ret *= adjusted_lphp_gain(params, AM::param_hp_active, AM::param_hp_mode, hp[0][0], freq, (float)srate);
-        ret *= adjusted_lphp_gain(params, AM::param_lp_active, AM::param_lp_mode, lp[0][0], freq, (float)srate);
-    }
-    ret *= (*params[AM::param_ls_active] > 0.f) ? lsL.freq_gain(freq, (float)srate) : 1;
-    ret *= (*params[AM::param_hs_active] > 0.f) ? hsL.freq_gain(freq, (float)srate) : 1;
+    for (int i = 0; i < gs.hp_stages; i++)
+        ret *= gs.hp.freq_gain(freq, (float)gs.srate);
+    for (int i = 0; i < gs.lp_stages; i++)
+        ret *= gs.lp.freq_gain(freq, (float)gs.srate);
+    ret *= gs.ls_active ? gs.ls.freq_gain(freq, (float)gs.srate) : 1;
+    ret *= gs.hs_active ? gs.hs.freq_gain(freq, (float)gs.srate) : 1;
     for (int i = 0; i < PeakBands; i++)
-        ret *= (*params[AM::param_p1_active + i * params_per_band] > 0.f) ? pL[i].freq_gain(freq, (float)srate) : 1;
+        ret *= gs.p_active[i] ? gs.p[i].freq_gain(freq, (float)gs.srate) : 1;
     return ret;
 }
 
 template<class BaseClass, bool has_lphp>
 inline std::string equalizerNband_audio_module<BaseClass, has_lphp>::get_crosshair_label(int x, int y, int sx, int sy, float q, int dB, int name, int note, int cents) const
 { 
-    return frequency_crosshair_label(x, y, sx, sy, q, dB, name, note, cents, 128 * *params[AM::param_zoom], 0);
+    return frequency_crosshair_label(x, y, sx, sy, q, dB, name, note, cents, 128 * graph.get_read().zoom, 0);
 }
 
 namespace calf_plugins {
@@ -674,11 +711,11 @@ uint32_t equalizer30band_audio_module::process(uint32_t offset, uint32_t numsamp
     numsamples += offset;
     if(bypassed) {
         // everything bypassed
+        float values[] = {0, 0, 0, 0};
+        meters.process_constant(values, orig_numsamples);
         while(offset < numsamples) {
             outs[0][offset] = ins[0][offset];
             outs[1][offset] = ins[1][offset];
-            float values[] = {0, 0, 0, 0};
-            meters.process(values);
             ++offset;
         }
     } else {
@@ -715,13 +752,13 @@ uint32_t equalizer30band_audio_module::process(uint32_t offset, uint32_t numsamp
             outs[0][offset] = outL;
             outs[1][offset] = outR;
 
-            // meters
-            float values[] = {(float)inL, (float)inR, (float)outL, (float)outR};
-            meters.process(values);
-
             // next sample
             ++offset;
         } // cycle trough samples
+        // meters
+        const float *buffers[] = {ins[0], ins[1], outs[0], outs[1]};
+        float gains[] = {*params[param_level_in], *params[param_level_in], 1, 1};
+        meters.process(buffers, gains, orig_offset, orig_numsamples);
         bypass.crossfade(ins, outs, 2, orig_offset, orig_numsamples);
     }
 
@@ -883,14 +920,15 @@ uint32_t emphasis_audio_module::process(uint32_t offset, uint32_t numsamples, ui
             numsamples -= 8;
         }
     }
+    uint32_t meter_offset = offset, meter_numsamples = numsamples;
     numsamples += offset;
     if(bypassed) {
         // everything bypassed
+        float values[] = {0, 0, 0, 0};
+        meters.process_constant(values, meter_numsamples);
         while(offset < numsamples) {
             outs[0][offset] = ins[0][offset];
             outs[1][offset] = ins[1][offset];
-            float values[] = {0, 0, 0, 0};
-            meters.process(values);
             ++offset;
         }
     } else {
@@ -918,12 +956,12 @@ uint32_t emphasis_audio_module::process(uint32_t offset, uint32_t numsamples, ui
             outs[0][offset] = outL;
             outs[1][offset] = outR;
             
-            float values[] = {inL, inR, outL, outR};
-            meters.process(values);
-            
             // next sample
             ++offset;
         } // cycle trough samples
+        const float *buffers[] = {ins[0], ins[1], outs[0], outs[1]};
+        float gains[] = {*params[param_level_in], *params[param_level_in], 1, 1};
+        meters.process(buffers, gains, meter_offset, meter_numsamples);
         bypass.crossfade(ins, outs, 2, orig_offset, orig_numsamples);
         // clean up
         riaacurvL.sanitize();
@@ -1027,9 +1065,10 @@ uint32_t xover_audio_module<XoverBaseClass>::process(uint32_t offset, uint32_t n
     while(offset < targ) {
         // cycle through samples
         
-        // level
+        // level and in meters (before any output is written, the host may process in place)
         for (int c = 0; c < AM::channels; c++) {
             in[c] = ins[c][offset] * *params[AM::param_level];
+            values[c + AM::bands * AM::channels] = ins[c][offset];
         }
         crossover.process(in);
         
@@ -1062,10 +1101,6 @@ uint32_t xover_audio_module<XoverBaseClass>::process(uint32_t offset, uint32_t n
                 values[b * AM::channels + c] = outs[ptr][offset];
             }
         }
-        // in meters
-        for (int c = 0; c < AM::channels; c++) {
-            values[c + AM::bands * AM::channels] = ins[c][offset];
-        }
         meters.process(values);
         // next sample
         ++offset;
@@ -1119,6 +1154,7 @@ vocoder_audio_module::vocoder_audio_module()
 void vocoder_audio_module::activate()
 {
     is_active = true;
+    smoothed.reset();
 }
 
 void vocoder_audio_module::deactivate()
@@ -1193,6 +1229,7 @@ uint32_t vocoder_audio_module::process(uint32_t offset, uint32_t numsamples, uin
     uint32_t orig_offset = offset;
     bool bypassed = bypass.update(*params[param_bypass] > 0.5f, numsamples);
     int solo = get_solo();
+    smoothed.update(numsamples);
     numsamples += offset;
     float led[32] = {0};
     if(bypassed) {
@@ -1206,35 +1243,45 @@ uint32_t vocoder_audio_module::process(uint32_t offset, uint32_t numsamples, uin
         }
     } else {
         // process
+        bool link = *params[param_link] > 0.5;
+        bool detectors = *params[param_detectors] > 0.5;
+        int analyzer_mode = *params[param_analyzer];
+        bool active[32];
+        for (int i = 0; i < bands; i++)
+            active[i] = !solo || *params[param_solo0 + i * band_params];
         while(offset < numsamples) {
             // cycle through samples
+            uint32_t s = offset - orig_offset;
             double outL = 0;
             double outR = 0;
             double pL   = 0;
             double pR   = 0;
             
             // carrier with level
-            double cL = ins[0][offset] * *params[param_carrier_in];
-            double cR = ins[1][offset] * *params[param_carrier_in];
+            double cL = ins[0][offset] * smoothed.get(smooth_carrier_in, s);
+            double cR = ins[1][offset] * smoothed.get(smooth_carrier_in, s);
             
             // modulator with level
-            double mL = ins[2][offset] * *params[param_mod_in];
-            double mR = ins[3][offset] * *params[param_mod_in];
+            double mL = ins[2][offset] * smoothed.get(smooth_mod_in, s);
+            double mR = ins[3][offset] * smoothed.get(smooth_mod_in, s);
             
             // noise generator
             double nL = (float)rand() / (float)RAND_MAX;
             double nR = (float)rand() / (float)RAND_MAX;
             
+            float proc = smoothed.get(smooth_proc, s);
             for (int i = 0; i < bands; i++) {
+                int b = smooth_bands + i * smooth_band_count;
                 double mL_ = mL;
                 double mR_ = mR;
-                double cL_ = cL + nL * *params[param_noise0 + i * band_params];
-                double cR_ = cR + nR * *params[param_noise0 + i * band_params];
+                float noise = smoothed.get(b + smooth_noise, s);
+                double cL_ = cL + nL * noise;
+                double cR_ = cR + nR * noise;
                 
-                if ((solo && *params[param_solo0 + i * band_params]) || !solo) {
+                if (active[i]) {
                     for (int j = 0; j < order; j++) {
                         // filter modulator
-                        if (*params[param_link] > 0.5) {
+                        if (link) {
                             mL_ = detector[0][j][i].process(std::max(mL_, mR_));
                             mR_ = mL_;
                         } else {
@@ -1250,25 +1297,26 @@ uint32_t vocoder_audio_module::process(uint32_t offset, uint32_t numsamples, uin
                     cR_ *= env_mods[1][i] * ((float)order / 2 + 4) * 4;
                     
                     // add band volume setting
-                    cL_ *= *params[param_volume0 + i * band_params];
-                    cR_ *= *params[param_volume0 + i * band_params];
+                    float volume = smoothed.get(b + smooth_volume, s);
+                    cL_ *= volume;
+                    cR_ *= volume;
                     
                     // add filtered modulator
-                    cL_ += mL_ * *params[param_mod0 + i * band_params];
-                    cR_ += mR_ * *params[param_mod0 + i * band_params];
+                    float bandmod = smoothed.get(b + smooth_bandmod, s);
+                    cL_ += mL_ * bandmod;
+                    cR_ += mR_ * bandmod;
                     
                     // Balance
-                    cL_ *= (*params[param_pan0 + i * band_params] > 0
-                         ? -*params[param_pan0 + i * band_params] + 1 : 1);
-                    cR_ *= (*params[param_pan0 + i * band_params] < 0
-                          ? *params[param_pan0 + i * band_params] + 1 : 1);
+                    float pan = smoothed.get(b + smooth_pan, s);
+                    cL_ *= (pan > 0 ? -pan + 1 : 1);
+                    cR_ *= (pan < 0 ? pan + 1 : 1);
                     
                     // add to outputs with proc level
-                    pL += cL_ * *params[param_proc];
-                    pR += cR_ * *params[param_proc];
+                    pL += cL_ * proc;
+                    pR += cR_ * proc;
                 }
                 // LED
-                if (*params[param_detectors] > 0.5)
+                if (detectors)
                     if (env_mods[0][i] + env_mods[1][i] > led[i])
                         led[i] = env_mods[0][i] + env_mods[1][i];
                     
@@ -1281,15 +1329,15 @@ uint32_t vocoder_audio_module::process(uint32_t offset, uint32_t numsamples, uin
             outR = pR;
             
             // dry carrier
-            outL += cL * *params[param_carrier];
-            outR += cR * *params[param_carrier];
+            outL += cL * smoothed.get(smooth_carrier, s);
+            outR += cR * smoothed.get(smooth_carrier, s);
             
             // dry modulator
-            outL += mL * *params[param_mod];
-            outR += mR * *params[param_mod];
+            outL += mL * smoothed.get(smooth_mod, s);
+            outR += mR * smoothed.get(smooth_mod, s);
             
             // analyzer
-            switch ((int)*params[param_analyzer]) {
+            switch (analyzer_mode) {
                 case 0:
                 default:
                     break;
@@ -1308,8 +1356,8 @@ uint32_t vocoder_audio_module::process(uint32_t offset, uint32_t numsamples, uin
             }
             
             // out level
-            outL *= *params[param_out];
-            outR *= *params[param_out];
+            outL *= smoothed.get(smooth_out, s);
+            outR *= smoothed.get(smooth_out, s);
             
             // send to outputs
             outs[0][offset] = outL;
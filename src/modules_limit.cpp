@@ -88,6 +88,12 @@ void limiter_audio_module::params_changed()
     }
 }
 
+int limiter_audio_module::get_tail_length() const
+{
+    // lookahead, and the release of the attenuation meter
+    return (int)(srate * (*params[param_attack] + *params[param_release]) * 0.001f) + vumeters::settle_time(srate);
+}
+
 void limiter_audio_module::set_sample_rate(uint32_t sr)
 {
     srate = sr;
@@ -105,11 +111,11 @@ uint32_t limiter_audio_module::process(uint32_t offset, uint32_t numsamples, uin
     numsamples += offset;
     if(bypassed) {
         // everything bypassed
+        float values[] = {0, 0, 0, 0, 1};
+        meters.process_constant(values, numsamples - offset);
         while(offset < numsamples) {
             outs[0][offset] = ins[0][offset];
             outs[1][offset] = ins[1][offset];
-            float values[] = {0, 0, 0, 0, 1};
-            meters.process(values);
             ++offset;
         }
         asc_led    = 0.f;
@@ -345,11 +351,11 @@ uint32_t multibandlimiter_audio_module::process(uint32_t offset, uint32_t numsam
     float batt = 0.f;
     if(bypassed) {
         // everything bypassed
+        float values[] = {0, 0, 0, 0, 1, 1, 1, 1};
+        meters.process_constant(values, numsamples - offset);
         while(offset < numsamples) {
             outs[0][offset] = ins[0][offset];
             outs[1][offset] = ins[1][offset];
-            float values[] = {0, 0, 0, 0, 1, 1, 1, 1};
-            meters.process(values);
             ++offset;
         }
         asc_led    = 0.f;
@@ -743,11 +749,11 @@ uint32_t sidechainlimiter_audio_module::process(uint32_t offset, uint32_t numsam
     float batt = 0.f;
     if(bypassed) {
         // everything bypassed
+        float values[] = {0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1};
+        meters.process_constant(values, numsamples - offset);
         while(offset < numsamples) {
             outs[0][offset] = ins[0][offset];
             outs[1][offset] = ins[1][offset];
-            float values[] = {0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1};
-            meters.process(values);
             ++offset;
         }
         asc_led    = 0.f;
@@ -130,8 +130,6 @@ float flanger_audio_module::freq_gain(int subindex, double freq) const
 
 
 phaser_audio_module::phaser_audio_module()
-: left(MaxStages, x1vals[0], y1vals[0])
-, right(MaxStages, x1vals[1], y1vals[1])
 {
     is_active = false;
 }
@@ -139,8 +137,7 @@ phaser_audio_module::phaser_audio_module()
 void phaser_audio_module::set_sample_rate(uint32_t sr)
 {
     srate = sr;
-    left.setup(sr);
-    right.setup(sr);
+    phaser.setup(sr);
     int meter[] = {param_meter_inL,  param_meter_inR, param_meter_outL, param_meter_outR};
     int clip[]  = {param_clip_inL, param_clip_inR, param_clip_outL, param_clip_outR};
     meters.init(params, meter, clip, 4, srate);
@@ -149,11 +146,9 @@ void phaser_audio_module::set_sample_rate(uint32_t sr)
 void phaser_audio_module::activate()
 {
     is_active = true;
-    left.reset();
-    right.reset();
-    last_r_phase = *params[par_stereo] * (1.f / 360.f);
-    left.reset_phase(0.f);
-    right.reset_phase(last_r_phase);
+    phaser.reset();
+    phaser.reset_phase(0.f);
+    phaser.set_stereo_phase(*params[par_stereo] * (1.f / 360.f));
 }
 
 void phaser_audio_module::deactivate()
@@ -171,26 +166,19 @@ void phaser_audio_module::params_changed()
     float fb = *params[par_fb];
     int lfo_active = *params[param_lfo];
     int stages = (int)*params[par_stages];
-    left.set_dry(dry); right.set_dry(dry);
-    left.set_wet(wet); right.set_wet(wet);
-    left.set_rate(rate); right.set_rate(rate);
-    left.set_base_frq(base_frq); right.set_base_frq(base_frq);
-    left.set_mod_depth(mod_depth); right.set_mod_depth(mod_depth);
-    left.set_fb(fb); right.set_fb(fb);
-    left.set_stages(stages); right.set_stages(stages);
-    left.set_lfo_active(lfo_active); right.set_lfo_active(lfo_active);
-    float r_phase = *params[par_stereo] * (1.f / 360.f);
+    phaser.set_dry(dry);
+    phaser.set_wet(wet);
+    phaser.set_rate(rate);
+    phaser.set_base_frq(base_frq);
+    phaser.set_mod_depth(mod_depth);
+    phaser.set_fb(fb);
+    phaser.set_stages(stages);
+    phaser.set_lfo_active(lfo_active);
+    phaser.set_stereo_phase(*params[par_stereo] * (1.f / 360.f));
     clear_reset = false;
     if (*params[par_reset] >= 0.5) {
         clear_reset = true;
-        left.reset_phase(0.f);
-        right.reset_phase(r_phase);
-    } else {
-        if (fabs(r_phase - last_r_phase) > 0.0001f) {
-            right.phase = left.phase;
-            right.inc_phase(r_phase);
-            last_r_phase = r_phase;
-        }
+        phaser.reset_phase(0.f);
     }
 }
 
@@ -222,7 +210,7 @@ bool phaser_audio_module::get_layers(int index, int generation, unsigned int &la
 
 float phaser_audio_module::freq_gain(int subindex, double freq) const
 {
-    return (subindex ? right : left).freq_gain(freq, srate);                
+    return phaser.freq_gain(subindex, freq, srate);                
 }
 
 
@@ -250,10 +238,13 @@ void rotary_speaker_audio_module::set_sample_rate(uint32_t sr)
 
 void rotary_speaker_audio_module::setup()
 {
-    crossover1l.set_lp_rbj(800.f, 0.7, (float)srate);
-    crossover1r.set_lp_rbj(800.f, 0.7, (float)srate);
-    crossover2l.set_hp_rbj(800.f, 0.7, (float)srate);
-    crossover2r.set_hp_rbj(800.f, 0.7, (float)srate);
+    dsp::biquad_coeffs hi, lo;
+    hi.set_bp_rbj(2000.f, 0.7, (float)srate);
+    lo.set_lp_rbj(800.f, 0.7, (float)srate);
+    crossover.set_lane(0, hi);
+    crossover.set_lane(1, hi);
+    crossover.set_lane(2, lo);
+    crossover.set_lane(3, lo);
 }
 
 void rotary_speaker_audio_module::activate()
@@ -285,6 +276,10 @@ void rotary_speaker_audio_module::control_change(int /*channel*/, int ctl, int v
 
 void rotary_speaker_audio_module::params_changed()
 {
+    dsp::biquad_coeffs bq;
+    bq.set_bp_rbj(1000.f*pow(4.0, *params[par_test]), 0.7, (float)srate);
+    damper.set_lane(0, bq);
+    damper.set_lane(1, bq);
     set_vibrato();
 }
 
@@ -355,6 +350,98 @@ inline bool rotary_speaker_audio_module::incr_towards(float &aspeed, float raspe
     return false;
 }
 
+/// Delay tap positions (16.16 fixed point) and AM gains for given rotor phases
+/// taps: treble left (3), treble right (3), bass left, bass right
+/// am: treble left, treble right, bass left, bass right
+static inline void rotor_taps(uint32_t phase_l, uint32_t phase_h, int shift, int pdelta, int md, float am_depth, int *taps, float *am)
+{
+    int xl = pseudo_sine_scl(phase_l), yl = pseudo_sine_scl(phase_l + 0x40000000);
+    int xh = pseudo_sine_scl(phase_h), yh = pseudo_sine_scl(phase_h + 0x40000000);
+    taps[0] = shift + md * xh;
+    taps[1] = shift + md * 65536 + pdelta - md * yh;
+    taps[2] = shift + md * 65536 + pdelta + pdelta - md * xh;
+    taps[3] = shift + md * 65536 - md * yh;
+    taps[4] = shift + pdelta + md * xh;
+    taps[5] = shift + pdelta + pdelta + md * yh;
+    taps[6] = shift + (md * xl >> 2);
+    taps[7] = shift + (md * yl >> 2);
+    am[0] = lerp(0.5f, xh * (1.f / 65536.f), am_depth);
+    am[1] = lerp(0.5f, yh * (1.f / 65536.f), am_depth);
+    am[2] = lerp(0.5f, yl * (1.f / 65536.f), am_depth);
+    am[3] = lerp(0.5f, xl * (1.f / 65536.f), am_depth);
+}
+
+template<bool Cubic>
+void rotary_speaker_audio_module::process_rotors(uint32_t offset, uint32_t nsamples)
+{
+    int shift = (int)(300000 * (*params[par_shift])), pdelta = (int)(300000 * (*params[par_spacing]));
+    int md = (int)(100 * (*params[par_moddepth]));
+    float mix = 0.5 * (1.0 - *params[par_micdistance]);
+    float mix2 = *params[par_reflection];
+    float mix3 = mix2 * mix2;
+    float am_depth = *params[par_am_depth];
+    float level_in = *params[param_level_in], level_out = *params[param_level_out];
+    
+    // rotor positions at the start of the current sub-block
+    int taps[8];
+    float am[4];
+    rotor_taps(phase_l, phase_h, shift, pdelta, md, am_depth, taps, am);
+    for (uint32_t i = offset, end = offset + nsamples; i < end; )
+    {
+        uint32_t n = std::min<uint32_t>(SubBlock, end - i);
+        phase_l += dphase_l * n;
+        phase_h += dphase_h * n;
+        int taps_end[8], dtaps[8];
+        float am_end[4], dam[4];
+        rotor_taps(phase_l, phase_h, shift, pdelta, md, am_depth, taps_end, am_end);
+        for (int k = 0; k < 8; k++)
+            dtaps[k] = (taps_end[k] - taps[k]) / (int)n;
+        for (int k = 0; k < 4; k++)
+            dam[k] = (am_end[k] - am[k]) * (1.f / n);
+        
+        for (uint32_t sub_end = i + n; i < sub_end; i++) {
+            float in_l = ins[0][i] * level_in, in_r = ins[1][i] * level_in;
+            float in_mono = atan(0.5f * (in_l + in_r));
+            // write first, so that the taps may read the current sample;
+            // every tap is one sample further away from the write position
+            delay.put(in_mono);
+            float fm[8];
+            for (int k = 0; k < 8; k++) {
+                fm[k] = Cubic ? delay.get_interp_hermite_1616(taps[k] + 0x10000) : delay.get_interp_1616(taps[k] + 0x10000);
+                taps[k] += dtaps[k];
+            }
+            double hi[2] = { fm[0] - mix2 * fm[1] + mix3 * fm[2], fm[3] - mix2 * fm[4] + mix3 * fm[5] };
+            damper.process(hi);
+            double out[4] = { hi[0], hi[1], fm[6], fm[7] };
+            for (int k = 0; k < 4; k++) {
+                out[k] = lerp((double)in_mono, out[k], (double)am[k]);
+                am[k] += dam[k];
+            }
+            crossover.process(out);
+            
+            float out_l = out[0] + out[2];
+            float out_r = out[1] + out[3];
+            
+            float mic_l = out_l + mix * (out_r - out_l);
+            float mic_r = out_r + mix * (out_l - out_r);
+            
+            outs[0][i] = mic_l * level_out;
+            outs[1][i] = mic_r * level_out;
+        }
+        // continue from the exact positions, not the accumulated ones
+        memcpy(taps, taps_end, sizeof(taps));
+        memcpy(am, am_end, sizeof(am));
+    }
+    crossover.sanitize();
+    damper.sanitize();
+    
+    const float *bufs[] = {ins[0], ins[1], outs[0], outs[1]};
+    float gains[] = {level_in, level_in, 1.f, 1.f};
+    meters.process(bufs, gains, offset, nsamples);
+    meter_l = pseudo_sine_scl(phase_l);
+    meter_h = pseudo_sine_scl(phase_h);
+}
+
 uint32_t rotary_speaker_audio_module::process(uint32_t offset, uint32_t nsamples, uint32_t inputs_mask, uint32_t outputs_mask)
 {
     bool bypassed = bypass.update(*params[param_bypass] > 0.5f, nsamples);
@@ -362,75 +449,14 @@ uint32_t rotary_speaker_audio_module::process(uint32_t offset, uint32_t nsamples
         for (unsigned int i = offset; i < nsamples + offset; i++) {
             outs[0][i] = ins[0][i];
             outs[1][i] = ins[1][i];
-            float values[] = {0,0,0,0};
-            meters.process(values);
         }
+        float values[] = {0,0,0,0};
+        meters.process_constant(values, nsamples);
     } else {
-        if (true)
-        {
-            crossover2l.set_bp_rbj(2000.f, 0.7, (float)srate);
-            crossover2r.copy_coeffs(crossover2l);
-            damper1l.set_bp_rbj(1000.f*pow(4.0, *params[par_test]), 0.7, (float)srate);
-            damper1r.copy_coeffs(damper1l);
-        }
+        if (*params[par_interp] >= 0.5f)
+            process_rotors<true>(offset, nsamples);
         else
-        {
-            crossover2l.set_hp_rbj(800.f, 0.7, (float)srate);
-            crossover2r.copy_coeffs(crossover2l);
-        }
-        int shift = (int)(300000 * (*params[par_shift])), pdelta = (int)(300000 * (*params[par_spacing]));
-        int md = (int)(100 * (*params[par_moddepth]));
-        float mix = 0.5 * (1.0 - *params[par_micdistance]);
-        float mix2 = *params[par_reflection];
-        float mix3 = mix2 * mix2;
-        double am_depth = *params[par_am_depth];
-        for (unsigned int i = 0; i < nsamples; i++) {
-            float in_l = ins[0][i + offset], in_r = ins[1][i + offset];
-            in_l *= *params[param_level_in];
-            in_r *= *params[param_level_in];
-            double in_mono = atan(0.5f * (in_l + in_r));
-            
-            int xl = pseudo_sine_scl(phase_l), yl = pseudo_sine_scl(phase_l + 0x40000000);
-            int xh = pseudo_sine_scl(phase_h), yh = pseudo_sine_scl(phase_h + 0x40000000);
-            // printf("%d %d %d\n", shift, pdelta, shift + pdelta + 20 * xl);
-            meter_l = xl;
-            meter_h = xh;
-            // float out_hi_l = in_mono - delay.get_interp_1616(shift + md * xh) + delay.get_interp_1616(shift + md * 65536 + pdelta - md * yh) - delay.get_interp_1616(shift + md * 65536 + pdelta + pdelta - md * xh);
-            // float out_hi_r = in_mono + delay.get_interp_1616(shift + md * 65536 - md * yh) - delay.get_interp_1616(shift + pdelta + md * xh) + delay.get_interp_1616(shift + pdelta + pdelta + md * yh);
-            float fm_hi_l = delay.get_interp_1616(shift + md * xh) - mix2 * delay.get_interp_1616(shift + md * 65536 + pdelta - md * yh) + mix3 * delay.get_interp_1616(shift + md * 65536 + pdelta + pdelta - md * xh);
-            float fm_hi_r = delay.get_interp_1616(shift + md * 65536 - md * yh) - mix2 * delay.get_interp_1616(shift + pdelta + md * xh) + mix3 * delay.get_interp_1616(shift + pdelta + pdelta + md * yh);
-            float out_hi_l = lerp(in_mono, (double)damper1l.process(fm_hi_l), lerp(0.5, xh * 1.0 / 65536.0, am_depth));
-            float out_hi_r = lerp(in_mono, (double)damper1r.process(fm_hi_r), lerp(0.5, yh * 1.0 / 65536.0, am_depth));
-    
-            float out_lo_l = lerp(in_mono, (double)delay.get_interp_1616(shift + (md * xl >> 2)), lerp(0.5, yl * 1.0 / 65536.0, am_depth)); // + delay.get_interp_1616(shift + md * 65536 + pdelta - md * yl);
-            float out_lo_r = lerp(in_mono, (double)delay.get_interp_1616(shift + (md * yl >> 2)), lerp(0.5, xl * 1.0 / 65536.0, am_depth)); // + delay.get_interp_1616(shift + md * 65536 + pdelta - md * yl);
-            
-            out_hi_l = crossover2l.process(out_hi_l); // sanitize(out_hi_l);
-            out_hi_r = crossover2r.process(out_hi_r); // sanitize(out_hi_r);
-            out_lo_l = crossover1l.process(out_lo_l); // sanitize(out_lo_l);
-            out_lo_r = crossover1r.process(out_lo_r); // sanitize(out_lo_r);
-            
-            float out_l = out_hi_l + out_lo_l;
-            float out_r = out_hi_r + out_lo_r;
-            
-            float mic_l = out_l + mix * (out_r - out_l);
-            float mic_r = out_r + mix * (out_l - out_r);
-            
-            outs[0][i + offset] = mic_l * *params[param_level_out];
-            outs[1][i + offset] = mic_r * *params[param_level_out];
-            delay.put(in_mono);
-            phase_l += dphase_l;
-            phase_h += dphase_h;
-            
-            float values[] = {in_l, in_r, outs[0][i + offset], outs[1][i + offset]};
-            meters.process(values);
-        }
-        crossover1l.sanitize();
-        crossover1r.sanitize();
-        crossover2l.sanitize();
-        crossover2r.sanitize();
-        damper1l.sanitize();
-        damper1r.sanitize();
+            process_rotors<false>(offset, nsamples);
         float delta = nsamples * 1.0 / srate;
         if (vibrato_mode == 5)
             update_speed_manual(delta);
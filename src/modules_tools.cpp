@@ -636,6 +636,7 @@ void multibandenhancer_audio_module::params_changed()
     for (int i = 0; i < strips; i++) {
         for (int j = 0; j < channels; j++) {
             dist[i][j].set_params(*params[param_blend0 + i], *params[param_drive0 + i]);
+            dist[i][j].set_quality((int)*params[param_quality]);
         }
     }
 }
@@ -865,11 +866,11 @@ uint32_t multispread_audio_module::process(uint32_t offset, uint32_t numsamples,
     numsamples += offset;
     if(bypassed) {
         // everything bypassed
+        float values[] = {0, 0, 0, 0};
+        meters.process_constant(values, numsamples - offset);
         while(offset < numsamples) {
             outs[0][offset] = ins[0][offset];
             outs[1][offset] = *params[param_mono] > 0.5 ? ins[0][offset] : ins[1][offset];
-            float values[] = {0, 0, 0, 0};
-            meters.process(values);
             // phase buffer handling
             phase_buffer[ppos]     = 0;
             phase_buffer[ppos + 1] = 0;
@@ -72,6 +72,7 @@ void organ_audio_module::params_changed() {
     polyphony_limit = dsp::clip(dsp::fastf2i_drm(*params[par_polyphony]), 1, 32);
     if (polyphony_limit < old_poly)
         trim_voices();
+    set_steal_policy((dsp::voice_steal_policy)dsp::clip(dsp::fastf2i_drm(*params[par_steal]), 0, dsp::steal_policy_count - 1));
     redraw = true;
     update_params();
 }
@@ -704,7 +705,7 @@ void organ_voice::update_pitch()
     dphase.set(dsp::midi_note_to_phase(note, 100 * parameters->global_transpose + parameters->global_detune, sample_rate) * inertia_pitchbend.get_last());
 }
 
-void organ_voice::render_block(int snapshot) {
+void organ_voice::render_block(int snapshot, int len) {
     if (note == -1)
         return;
 
@@ -713,12 +714,13 @@ void organ_voice::render_block(int snapshot) {
     if (!amp.get_active())
     {
         if (use_percussion())
-            render_percussion_to(output_buffer, BlockSize);
+            render_percussion_to(output_buffer, len);
         return;
     }
 
+    // inertias are counted in samples, so that short blocks don't speed them up
     inertia_pitchbend.set_inertia(parameters->pitch_bend);
-    inertia_pitchbend.step();
+    inertia_pitchbend.step_many(len);
     update_pitch();
     dsp::fixed_point<int, 20> tphase, tdphase;
     unsigned int foldvalue = parameters->foldvalue * inertia_pitchbend.get_last();
@@ -748,7 +750,7 @@ void organ_voice::render_block(int snapshot) {
             float ampr = amp * 0.5f * (1 + parameters->pan[h]);
             float (*out)[Channels] = aux_buffers[dsp::fastf2i_drm(parameters->routing[h])];
             
-            for (int i=0; i < (int)BlockSize; i++) {
+            for (int i=0; i < len; i++) {
                 float wv = big_wave(data, tphase);
                 out[i][0] += wv * ampl;
                 out[i][1] += wv * ampr;
@@ -773,7 +775,7 @@ void organ_voice::render_block(int snapshot) {
             float ampr = amp * 0.5f * (1 + parameters->pan[h]);
             float (*out)[Channels] = aux_buffers[dsp::fastf2i_drm(parameters->routing[h])];
             
-            for (int i=0; i < (int)BlockSize; i++) {
+            for (int i=0; i < len; i++) {
                 float wv = wave(data, tphase);
                 out[i][0] += wv * ampl;
                 out[i][1] += wv * ampr;
@@ -785,7 +787,8 @@ void organ_voice::render_block(int snapshot) {
     bool is_quad = parameters->quad_env >= 0.5f;
     
     expression.set_inertia(parameters->cutoff);
-    phase += dphase * BlockSize;
+    expression.step_many(len);
+    phase += dphase * len;
     float escl[EnvCount], eval[EnvCount];
     for (int i = 0; i < EnvCount; i++)
         escl[i] = (1.f + parameters->envs[i].velscale * (velocity - 1.f));
@@ -808,7 +811,7 @@ void organ_voice::render_block(int snapshot) {
         {
             mod += parameters->filters[i].envmod[j] * eval[j];
         }
-        if (i) mod += expression.get() * 1200 * 4;
+        if (i) mod += expression.get_last() * 1200 * 4;
         float fc = parameters->filters[i].cutoff * pow(2.0f, mod * (1.f / 1200.f));
         if (i == 0 && parameters->filter1_type >= 0.5f)
             filterL[i].set_hp_rbj(dsp::clip<float>(fc, 10, 18000), parameters->filters[i].resonance, sample_rate);
@@ -826,7 +829,7 @@ void organ_voice::render_block(int snapshot) {
     for (int i = 0; i < EnvCount; i++)
     {
         float pre = eval[i];
-        envs[i].advance();
+        envs[i].advance(len * (1.0 / BlockSize));
         int mode = fastf2i_drm(parameters->envs[i].ampctl);
         if (!envs[i].stopped())
             any_running = true;
@@ -837,17 +840,17 @@ void organ_voice::render_block(int snapshot) {
         amp_post[mode - 1] *= post;
     }
     if (vibrato_mode >= lfomode_direct && vibrato_mode <= lfomode_filter2)
-        vibrato.process(parameters, aux_buffers[vibrato_mode - lfomode_direct], BlockSize, sample_rate);
+        vibrato.process(parameters, aux_buffers[vibrato_mode - lfomode_direct], len, sample_rate);
     if (!any_running)
         finishing = true;
     // calculate delta from pre and post
     for (int i = 0; i < ampctl_count - 1; i++)
-        amp_post[i] = (amp_post[i] - amp_pre[i]) * (1.0 / BlockSize);
+        amp_post[i] = (amp_post[i] - amp_pre[i]) * (1.0 / len);
     float a0 = amp_pre[0], a1 = amp_pre[1], a2 = amp_pre[2], a3 = amp_pre[3];
     float d0 = amp_post[0], d1 = amp_post[1], d2 = amp_post[2], d3 = amp_post[3];
     if (parameters->filter_chain >= 0.5f)
     {
-        for (int i=0; i < (int) BlockSize; i++) {
+        for (int i=0; i < len; i++) {
             output_buffer[i][0] = a3 * (a0 * output_buffer[i][0] + a2 * filterL[1].process(a1 * filterL[0].process(aux_buffers[1][i][0]) + aux_buffers[2][i][0]));
             output_buffer[i][1] = a3 * (a0 * output_buffer[i][1] + a2 * filterR[1].process(a1 * filterR[0].process(aux_buffers[1][i][1]) + aux_buffers[2][i][1]));
             a0 += d0, a1 += d1, a2 += d2, a3 += d3;
@@ -855,7 +858,7 @@ void organ_voice::render_block(int snapshot) {
     }
     else
     {
-        for (int i=0; i < (int) BlockSize; i++) {
+        for (int i=0; i < len; i++) {
             output_buffer[i][0] = a3 * (a0 * output_buffer[i][0] + a1 * filterL[0].process(aux_buffers[1][i][0]) + a2 * filterL[1].process(aux_buffers[2][i][0]));
             output_buffer[i][1] = a3 * (a0 * output_buffer[i][1] + a1 * filterR[0].process(aux_buffers[1][i][1]) + a2 * filterR[1].process(aux_buffers[2][i][1]));
             a0 += d0, a1 += d1, a2 += d2, a3 += d3;
@@ -866,11 +869,11 @@ void organ_voice::render_block(int snapshot) {
     filterL[1].sanitize();
     filterR[1].sanitize();
     if (vibrato_mode == lfomode_voice)
-        vibrato.process(parameters, output_buffer, BlockSize, sample_rate);
+        vibrato.process(parameters, output_buffer, len, sample_rate);
 
     if (finishing)
     {
-        for (int i = 0; i < (int) BlockSize; i++) {
+        for (int i = 0; i < len; i++) {
             output_buffer[i][0] *= amp.get();
             output_buffer[i][1] *= amp.get();
             amp.age_lin((1.0/44100.0)/0.03,0.0);
@@ -878,7 +881,7 @@ void organ_voice::render_block(int snapshot) {
     }
     
     if (use_percussion())
-        render_percussion_to(output_buffer, BlockSize);
+        render_percussion_to(output_buffer, len);
 
 }
 
@@ -923,9 +926,17 @@ void organ_voice::steal()
     stolen = true;
 }
 
+float organ_voice::get_level()
+{
+    float level = 0.f;
+    for (int i = 0; i < EnvCount; i++)
+        level = std::max<float>(level, envs[i].value);
+    return level * amp.get();
+}
+
 void organ_voice::reset()
 {
-    inertia_pitchbend.ramp.set_length(sample_rate / (BlockSize * 30)); // 1/30s    
+    inertia_pitchbend.ramp.set_length(sample_rate / 30); // 1/30s    
     vibrato.reset();
     phase = 0;
     for (int i = 0; i < FilterCount; i++)
@@ -950,13 +961,6 @@ void drawbar_organ::update_params()
     parameters->foldvalue = (int)(dphase);
 }
 
-dsp::voice *drawbar_organ::alloc_voice()
-{
-    block_voice<organ_voice> *v = new block_voice<organ_voice>();
-    v->parameters = parameters;
-    return v;
-}
-
 void drawbar_organ::percussion_note_on(int note, int vel)
 {
     percussion.perc_note_on(note, vel);
@@ -1081,7 +1085,7 @@ void drawbar_organ::render_separate(float *output[], int nsamples)
 {
     float buf[MAX_SAMPLE_RUN][2];
     dsp::zero(&buf[0][0], 2 * nsamples);
-    basic_synth::render_to(buf, nsamples);
+    render_voices_of<block_voice<organ_voice> >(buf, nsamples);
     if (dsp::fastf2i_drm(parameters->lfo_mode) == organ_voice_base::lfomode_global)
     {
         for (int i = 0; i < nsamples; i += 64)
@@ -34,7 +34,9 @@ using namespace std;
 plugin_gui_widget::plugin_gui_widget(gui_environment_iface *_env, main_window_iface *_main)
 {
     gui = NULL;
+    container = NULL;
     toplevel = NULL;
+    scheduled = false;
     environment = _env;
     main = _main;
     assert(environment);
@@ -48,13 +50,9 @@ void plugin_gui_widget::on_window_destroyed(GtkWidget *window, gpointer data)
     delete self;
 }
 
-gboolean plugin_gui_widget::on_idle(void *data)
+bool plugin_gui_widget::on_frame()
 {
-    plugin_gui_widget *self = (plugin_gui_widget *)data;
-    //if (!self->refresh_controller.check_redraw(GTK_WIDGET(self->toplevel)))
-        //return TRUE;
-    self->gui->on_idle();
-    return TRUE;
+    return gui->on_idle();
 }
 
 void plugin_gui_widget::create_gui(plugin_ctl_iface *_jh)
@@ -65,7 +63,8 @@ void plugin_gui_widget::create_gui(plugin_ctl_iface *_jh)
         xml = "<hbox />";
     }
     container = gui->create_from_xml(_jh, xml);
-    source_id = g_timeout_add_full(G_PRIORITY_DEFAULT, 1000/30, on_idle, this, NULL); // 30 fps should be enough for everybody
+    gui_refresh_scheduler::get().add_client(this);
+    scheduled = true;
     gui->plugin->send_configures(gui);
 }
 
@@ -87,9 +86,9 @@ void plugin_gui_widget::refresh()
 
 void plugin_gui_widget::cleanup()
 {
-    if (source_id)
-        g_source_remove(source_id);
-    source_id = 0;
+    if (scheduled)
+        gui_refresh_scheduler::get().remove_client(this);
+    scheduled = false;
 }
 
 plugin_gui_widget::~plugin_gui_widget()
@@ -23,17 +23,27 @@
 using namespace dsp;
 using namespace std;
 
-void basic_synth::init_voices(int count)
+void basic_synth::update_priority(voice *v)
 {
-    allocated_voices.init(count);
-    active_voices.init(count);
-    unused_voices.init(count);
-    for (int i = 0; i < count; i++)
+    int pclass = get_priority_class(v->get_priority());
+    if (pclass == v->priority_class)
+        return;
+    if (v->priority_class != -1)
+        priority_lists[v->priority_class].remove(v);
+    priority_lists[pclass].push_back(v);
+    v->priority_class = pclass;
+}
+
+basic_synth::voice_array::iterator basic_synth::release_voice(voice_array::iterator i)
+{
+    dsp::voice *v = *i;
+    if (v->priority_class != -1)
     {
-        dsp::voice *v = alloc_voice();
-        allocated_voices.add(v);
-        unused_voices.add(v);
+        priority_lists[v->priority_class].remove(v);
+        v->priority_class = -1;
     }
+    unused_voices.add(v);
+    return active_voices.erase(i);
 }
 
 void basic_synth::kill_note(int note, int vel, bool just_one)
@@ -42,16 +52,17 @@ void basic_synth::kill_note(int note, int vel, bool just_one)
         // preserve sostenuto notes
         if ((*it)->get_current_note() == note && !(sostenuto && (*it)->sostenuto)) {
             (*it)->note_off(vel);
+            update_priority(*it);
             if (just_one)
                 return;
         }
     }
 }
 
-dsp::voice *basic_synth::give_voice()
+dsp::voice *basic_synth::give_voice(int note)
 {
     if (active_voices.size() >= polyphony_limit)
-        steal_voice();
+        steal_voice(note);
     if (unused_voices.empty())
         return NULL;
     else {
@@ -61,42 +72,69 @@ dsp::voice *basic_synth::give_voice()
     }   
 }
 
-void basic_synth::steal_voice()
+void basic_synth::steal_voice(int note)
 {
-    dsp::voice *found = NULL;
-    float priority = 10000;
-    //int idx = 0;
-    for_all_voices(i)
+    // lowest non-empty priority class, unstealable voices are never considered
+    voice_list *list = NULL;
+    for (int i = 0; i < prio_unstealable; i++)
     {
-        //printf("Voice %d priority %f at %p\n", idx++, (*i)->get_priority(), *i);
-        if ((*i)->get_priority() < priority)
+        if (!priority_lists[i].empty())
         {
-            priority = (*i)->get_priority();
-            found = *i;
+            list = &priority_lists[i];
+            break;
         }
     }
-    //printf("Found: %p\n\n", *found);
-    if (!found)
+    if (!list)
         return;
     
+    dsp::voice *found = list->head;
+    switch(steal_policy)
+    {
+        case steal_oldest:
+        default:
+            break;
+        case steal_quietest:
+        {
+            float level = found->get_level();
+            for (dsp::voice *v = found->next_voice; v; v = v->next_voice)
+            {
+                float vlevel = v->get_level();
+                if (vlevel < level)
+                {
+                    level = vlevel;
+                    found = v;
+                }
+            }
+            break;
+        }
+        case steal_same_note:
+            if (note == -1)
+                break;
+            for (int i = 0; i < prio_unstealable; i++)
+            {
+                for (dsp::voice *v = priority_lists[i].head; v; v = v->next_voice)
+                {
+                    if (v->started_note == note)
+                    {
+                        found = v;
+                        i = prio_unstealable;
+                        break;
+                    }
+                }
+            }
+            break;
+    }
     found->steal();
+    update_priority(found);
 }
 
 void basic_synth::trim_voices()
 {
-    // count stealable voices
-    unsigned int count = 0;
-    for_all_voices(i)
-    {
-        if ((*i)->get_priority() < 10000)
-            count++;
-    }
-    // printf("Count=%d limit=%d\n", count, polyphony_limit);
     // steal any voices above polyphony limit
-    if (count > polyphony_limit) {
-        for (unsigned int i = 0; i < count - polyphony_limit; i++)
-            steal_voice();
-    }
+    unsigned int count = get_stealable_count();
+    // printf("Count=%d limit=%d\n", count, polyphony_limit);
+    for (; count > polyphony_limit; count--)
+        steal_voice();
 }
 
 void basic_synth::note_on(int note, int vel)
@@ -106,15 +144,17 @@ void basic_synth::note_on(int note, int vel)
         return;
     }
     bool perc = check_percussion();
-    dsp::voice *v = give_voice();
+    dsp::voice *v = give_voice(note);
     if (!v)
         return;
     v->setup(sample_rate);
     v->released = false;
     v->sostenuto = false;
+    v->started_note = note;
     gate.set(note);
     v->note_on(note, vel);
     active_voices.add(v);
+    update_priority(v);
     if (perc) {
         percussion_note_on(note, vel);
     }
@@ -150,6 +190,7 @@ void basic_synth::on_pedal_release()
             (*i)->released = true;
             (*i)->note_off(127);
         }
+        update_priority(*i);
     }
 }
 
@@ -169,6 +210,7 @@ void basic_synth::control_change(int ctl, int val)
             // SOSTENUTO was pressed - move all notes onto sustain stack
             for_all_voices(i) {
                 (*i)->sostenuto = true;
+                update_priority(*i);
             }
         }
         if (!sostenuto && prev) {
@@ -187,6 +229,7 @@ void basic_synth::control_change(int ctl, int val)
                 (*i)->note_off(127);
             else
                 (*i)->steal();
+            update_priority(*i);
         }
     }
     if (ctl == 121) { 
@@ -207,17 +250,17 @@ void basic_synth::render_to(float (*output)[2], int nsamples)
         dsp::voice *v = *i;
         v->render_to(output, nsamples);
         if (!v->get_active()) {
-            i = active_voices.erase(i);
-            unused_voices.add(v);
+            i = release_voice(i);
             continue;
         }
+        update_priority(v);
         i++;
     }
 } 
 
 basic_synth::~basic_synth()
 {
-    for (voice_array::iterator i = allocated_voices.begin(); i != allocated_voices.end(); ++i)
-        delete *i;
+    if (voice_arena)
+        free_voice_arena(voice_arena);
 }
 
@@ -54,6 +54,8 @@ void wavetable_voice::note_on(int note, int vel)
 {
     typedef wavetable_metadata md;
     this->note = note;
+    // not rendered anything yet, so don't make it a candidate for quietest-first stealing
+    amp_env = 1.f;
     float s = 0.001;
     velocity = vel / 127.0;
     lfo1.reset();
@@ -90,12 +92,10 @@ void wavetable_voice::steal()
 {
 }
 
-void wavetable_voice::render_block(int current_snapshot)
+void wavetable_voice::prepare_block(float *modsrc, int stride, int len)
 {
     typedef wavetable_metadata md;
     
-    const float step = 1.f / BlockSize;
-
     float s = 0.001;
     float scl[EnvCount];
     int espc = md::par_eg2attack - md::par_eg1attack;
@@ -106,17 +106,44 @@ void wavetable_voice::render_block(int current_snapshot)
     }
     
     for (int i = 0; i < EnvCount; i++)
-        envs[i].advance();    
+        envs[i].advance(len * (1.0 / BlockSize));
     
-    uint32_t crate = parent->get_crate();
+    // LFOs are stepped once per block, whatever its length
+    float crate = sample_rate * (1.f / len);
     lfo1.set_freq(*params[md::par_lfo1rate], crate);
     lfo2.set_freq(*params[md::par_lfo2rate], crate);
     lfo1.last = lfo1.get();
     lfo2.last = lfo2.get();
 
-    float modsrc[wavetable_metadata::modsrc_count] = { 1.f, velocity, parent->inertia_pressure.get_last(), parent->modwheel_value, (float)envs[0].value * scl[0], (float)envs[1].value * scl[1], (float)envs[2].value * scl[2], 0.5f+0.5f*lfo1.last, 0.5f+0.5f*lfo2.last, dsp::clip<float>(note / 120.0, 0.f, 1.f)};
-    parent->calculate_modmatrix(moddest, md::moddest_count, modsrc);
-    calc_derived_dests(envs[0].value * scl[0] * scl[0]);
+    amp_env = envs[0].value * scl[0] * scl[0];
+
+    modsrc[md::modsrc_none * stride] = 1.f;
+    modsrc[md::modsrc_velocity * stride] = velocity;
+    modsrc[md::modsrc_pressure * stride] = parent->inertia_pressure.get_last();
+    modsrc[md::modsrc_modwheel * stride] = parent->modwheel_value;
+    modsrc[md::modsrc_env1 * stride] = (float)envs[0].value * scl[0];
+    modsrc[md::modsrc_env2 * stride] = (float)envs[1].value * scl[1];
+    modsrc[md::modsrc_env3 * stride] = (float)envs[2].value * scl[2];
+    modsrc[md::modsrc_lfo1 * stride] = 0.5f+0.5f*lfo1.last;
+    modsrc[md::modsrc_lfo2 * stride] = 0.5f+0.5f*lfo2.last;
+    modsrc[md::modsrc_keyfollow * stride] = dsp::clip<float>(note / 120.0, 0.f, 1.f);
+}
+
+void wavetable_voice::render_block(int current_snapshot, int len)
+{
+    float modsrc[wavetable_metadata::modsrc_count];
+    prepare_block(modsrc, 1, len);
+    parent->calculate_modmatrix(moddest, wavetable_metadata::moddest_count, modsrc);
+    render_prepared_block(current_snapshot, len);
+}
+
+void wavetable_voice::render_prepared_block(int current_snapshot, int len)
+{
+    typedef wavetable_metadata md;
+    
+    const float step = 1.f / len;
+
+    calc_derived_dests(amp_env);
 
     int ospc = md::par_o2level - md::par_o1level;
     float pb = moddest[md::moddest_pitch] + parent->control_snapshots[current_snapshot].pitchbend;
@@ -131,7 +158,7 @@ void wavetable_voice::render_block(int current_snapshot)
     }
     float osstep[2] = { (oscshift[0] - last_oscshift[0]) * step, (oscshift[1] - last_oscshift[1]) * step };
     float oastep[2] = { (cur_oscamp[0] - last_oscamp[0]) * step, (cur_oscamp[1] - last_oscamp[1]) * step };
-    for (int i = 0; i < BlockSize; i++) {        
+    for (int i = 0; i < len; i++) {        
         float value = 0.f;
 
         for (int j = 0; j < OscCount; j++) {
@@ -151,6 +178,52 @@ void wavetable_voice::render_block(int current_snapshot)
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void wavetable_audio_module::render_voice_blocks(int current_snapshot, int len)
+{
+    int nvoices = 0;
+    for_all_voices(i)
+        ((wavetable_voice *)*i)->prepare_block(&batch_modsrc[0][nvoices++], VoiceCount, len);
+    calculate_modmatrix_multi(&batch_moddest[0][0], moddest_count, &batch_modsrc[0][0], VoiceCount, nvoices);
+    nvoices = 0;
+    for_all_voices(i)
+    {
+        wavetable_voice *v = (wavetable_voice *)*i;
+        v->set_moddest(&batch_moddest[0][nvoices++], VoiceCount);
+        v->render_prepared_block(current_snapshot, len);
+    }
+}
+
+void wavetable_audio_module::render_voices(float (*buf)[2], int nsamples)
+{
+    // same block splitting as in block_voice - the last block is cut short at the end of the slice
+    int current_snapshot = 0;
+    for (int p = 0; p < nsamples; p += BlockSize)
+    {
+        int len = std::min<int>(BlockSize, nsamples - p);
+        render_voice_blocks(current_snapshot++, len);
+        for_all_voices(i)
+        {
+            float (*obuf)[wavetable_voice::Channels] = ((wavetable_voice *)*i)->output_buffer;
+            for (int j = 0; j < len; j++)
+            {
+                buf[p + j][0] += obuf[j][0];
+                buf[p + j][1] += obuf[j][1];
+            }
+        }
+    }
+    // eliminate voices that aren't sounding anymore, the others may have been released by their envelope
+    for (voice_array::iterator i = active_voices.begin(); i != active_voices.end(); ) {
+        if (!((wavetable_voice *)*i)->wavetable_voice::get_active()) {
+            i = release_voice(i);
+            continue;
+        }
+        update_priority(*i);
+        i++;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
 const int16_t *wavetable_voice::get_last_table(int osc) const
 {
     float os = dsp::clip<double>(last_oscshift[osc] * 1.27, 0, 127);
@@ -216,7 +289,9 @@ wavetable_audio_module::wavetable_audio_module()
 , inertia_pitchbend(64)
 , inertia_pressure(64)
 {
-    init_voices(36);
+    init_voices<dsp::block_voice<wavetable_voice> >(VoiceCount);
+    for (voice_array::iterator i = allocated_voices.begin(); i != allocated_voices.end(); ++i)
+        static_cast<wavetable_voice *>(*i)->set_params_ptr(this, sample_rate);
     last_voice = (wavetable_voice *)allocated_voices.items[0];
 
     panic_flag = false;